@@ -19,38 +19,156 @@
 #include "itkImageFileReader.h"
 #include "itkPhaseSymmetryImageFilter.h"
 #include "itkImageFileWriter.h"
+#include "itksys/Glob.hxx"
+#include "itksys/SystemTools.hxx"
 #include "PhaseSymmetryFilterCLP.h"
 
-template <unsigned int VDimension>
-int
-PhaseSymmetryFilter(int argc, char * argv[])
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+
+namespace
 {
-  PARSE_ARGS;
 
-  using PixelType = float;
-  const unsigned int Dimension = VDimension;
-  using ImageType = itk::Image<PixelType, Dimension>;
+// A queue of bounded length between two threads. Push() blocks while the
+// queue is full and not closed, and Pop() blocks while it is empty and not
+// closed.
+template <typename T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(std::size_t capacity)
+    : m_Capacity(std::max<std::size_t>(capacity, 1))
+  {}
 
-  using ReaderType = itk::ImageFileReader<ImageType>;
-  typename ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName(inputImage);
-  try
+  // Returns false, and drops the item, once the queue is closed
+  bool
+  Push(T item)
   {
-    reader->Update();
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_NotFull.wait(lock, [this] { return m_Items.size() < m_Capacity || m_Closed; });
+    if (m_Closed)
+    {
+      return false;
+    }
+    m_Items.push(std::move(item));
+    m_NotEmpty.notify_one();
+    return true;
   }
-  catch (itk::ExceptionObject & excp)
+
+  // Returns false once the queue is closed and empty
+  bool
+  Pop(T & item)
   {
-    std::cerr << excp << std::endl;
-    return EXIT_FAILURE;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_NotEmpty.wait(lock, [this] { return !m_Items.empty() || m_Closed; });
+    if (m_Items.empty())
+    {
+      return false;
+    }
+    item = std::move(m_Items.front());
+    m_Items.pop();
+    m_NotFull.notify_one();
+    return true;
   }
 
-  typename ImageType::Pointer readImage = reader->GetOutput();
-  // TODO: necessary?
-  readImage->DisconnectPipeline();
+  void
+  Close()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Closed = true;
+    m_NotEmpty.notify_all();
+    m_NotFull.notify_all();
+  }
 
-  using PhaseSymmetryFilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
-  typename PhaseSymmetryFilterType::Pointer phaseSymmetryFilter = PhaseSymmetryFilterType::New();
-  phaseSymmetryFilter->SetInput(readImage);
+private:
+  std::size_t             m_Capacity;
+  std::queue<T>           m_Items;
+  bool                    m_Closed{ false };
+  std::mutex              m_Mutex;
+  std::condition_variable m_NotFull;
+  std::condition_variable m_NotEmpty;
+};
+
+
+// Runs a function once: when Run() is called, or when it goes out of scope,
+// normally or by an exception
+class ScopeGuard
+{
+public:
+  explicit ScopeGuard(std::function<void()> function)
+    : m_Function(std::move(function))
+  {}
+
+  ScopeGuard(const ScopeGuard &) = delete;
+  ScopeGuard &
+  operator=(const ScopeGuard &) = delete;
+
+  ~ScopeGuard() { this->Run(); }
+
+  void
+  Run()
+  {
+    if (m_Function)
+    {
+      std::function<void()> function;
+      std::swap(function, m_Function);
+      function();
+    }
+  }
+
+private:
+  std::function<void()> m_Function;
+};
+
+
+// Expands a glob pattern, or "@" followed by a file that lists one filename
+// per line
+std::vector<std::string>
+ExpandBatchInputs(const std::string & inputs)
+{
+  std::vector<std::string> fileNames;
+  if (!inputs.empty() && inputs[0] == '@')
+  {
+    std::ifstream listFile(inputs.substr(1).c_str());
+    std::string   line;
+    while (std::getline(listFile, line))
+    {
+      line = itksys::SystemTools::TrimWhitespace(line);
+      if (!line.empty())
+      {
+        fileNames.push_back(line);
+      }
+    }
+    return fileNames;
+  }
+
+  itksys::Glob glob;
+  glob.FindFiles(inputs);
+  fileNames = glob.GetFiles();
+  std::sort(fileNames.begin(), fileNames.end());
+  return fileNames;
+}
+
+
+template <typename TFilter>
+void
+ConfigurePhaseSymmetryFilter(TFilter *                   phaseSymmetryFilter,
+                             const std::vector<double> & wavelengths,
+                             const std::vector<double> & orientations,
+                             double                      sigma,
+                             double                      angularBandwidth,
+                             int                         polarity,
+                             double                      noiseThreshold)
+{
+  constexpr unsigned int Dimension = TFilter::InputImageDimension;
 
   using Array2DType = itk::Array2D<double>;
   const unsigned int scales = wavelengths.size() / Dimension;
@@ -80,6 +198,43 @@ PhaseSymmetryFilter(int argc, char * argv[])
   phaseSymmetryFilter->SetAngleBandwidth(angularBandwidth);
   phaseSymmetryFilter->SetPolarity(polarity);
   phaseSymmetryFilter->SetNoiseThreshold(noiseThreshold);
+}
+
+} // end anonymous namespace
+
+
+template <unsigned int VDimension>
+int
+PhaseSymmetryFilter(int argc, char * argv[])
+{
+  PARSE_ARGS;
+
+  using PixelType = float;
+  const unsigned int Dimension = VDimension;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputImage);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  typename ImageType::Pointer readImage = reader->GetOutput();
+  // TODO: necessary?
+  readImage->DisconnectPipeline();
+
+  using PhaseSymmetryFilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
+  typename PhaseSymmetryFilterType::Pointer phaseSymmetryFilter = PhaseSymmetryFilterType::New();
+  phaseSymmetryFilter->SetInput(readImage);
+  ConfigurePhaseSymmetryFilter(
+    phaseSymmetryFilter.GetPointer(), wavelengths, orientations, sigma, angularBandwidth, polarity, noiseThreshold);
 
   phaseSymmetryFilter->Initialize();
 
@@ -100,28 +255,223 @@ PhaseSymmetryFilter(int argc, char * argv[])
   return EXIT_SUCCESS;
 }
 
+
+// Reads, filters and writes a list of images in three overlapped stages: a
+// reader thread, the calling thread, which filters, and a writer thread,
+// connected by bounded queues. The filters, with their filter banks, of the
+// batchQueueLength most recently used image geometries are kept.
+template <unsigned int VDimension>
+int
+PhaseSymmetryFilterBatch(const std::vector<std::string> & inputFileNames, int argc, char * argv[])
+{
+  PARSE_ARGS;
+
+  using PixelType = float;
+  const unsigned int Dimension = VDimension;
+  using ImageType = itk::Image<PixelType, Dimension>;
+  using ImagePointer = typename ImageType::Pointer;
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  using PhaseSymmetryFilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
+
+  // Inputs of the same name in different directories would overwrite each
+  // other's output
+  std::vector<std::string> outputFileNames;
+  std::set<std::string>    usedOutputFileNames;
+  for (const std::string & inputFileName : inputFileNames)
+  {
+    outputFileNames.push_back(outputImage + "/" + itksys::SystemTools::GetFilenameName(inputFileName));
+    if (!usedOutputFileNames.insert(outputFileNames.back()).second)
+    {
+      std::cerr << "More than one input is written to " << outputFileNames.back() << ", the last from "
+                << inputFileName << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!itksys::SystemTools::MakeDirectory(outputImage))
+  {
+    std::cerr << "Could not create the output directory " << outputImage << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // An input index with its image, which is null when reading failed
+  using ReadItem = std::pair<std::size_t, ImagePointer>;
+  // An output filename with its image
+  using WriteItem = std::pair<std::string, ImagePointer>;
+  const std::size_t         queueLength = std::max(batchQueueLength, 1);
+  BoundedQueue<ReadItem>    readQueue(queueLength);
+  BoundedQueue<WriteItem>   writeQueue(queueLength);
+  std::atomic<unsigned int> failures{ 0 };
+
+  std::thread readThread([&inputFileNames, &readQueue, &failures] {
+    for (std::size_t ii = 0; ii < inputFileNames.size(); ++ii)
+    {
+      ImagePointer                 image;
+      typename ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName(inputFileNames[ii]);
+      try
+      {
+        reader->Update();
+        image = reader->GetOutput();
+        image->DisconnectPipeline();
+      }
+      catch (itk::ExceptionObject & excp)
+      {
+        std::cerr << inputFileNames[ii] << ": " << excp << std::endl;
+        ++failures;
+      }
+      if (!readQueue.Push(ReadItem(ii, image)))
+      {
+        break;
+      }
+    }
+    readQueue.Close();
+  });
+
+  std::thread writeThread([&writeQueue, &failures] {
+    WriteItem item;
+    while (writeQueue.Pop(item))
+    {
+      typename WriterType::Pointer writer = WriterType::New();
+      writer->SetInput(item.second);
+      writer->SetFileName(item.first);
+      try
+      {
+        writer->Update();
+      }
+      catch (itk::ExceptionObject & excp)
+      {
+        std::cerr << item.first << ": " << excp << std::endl;
+        ++failures;
+      }
+    }
+  });
+
+  // Closing both queues stops the reader and lets the writer finish its
+  // queue, so that the threads are joined however the filtering stage exits
+  ScopeGuard joinThreads([&readQueue, &writeQueue, &readThread, &writeThread] {
+    readQueue.Close();
+    writeQueue.Close();
+    readThread.join();
+    writeThread.join();
+  });
+
+  // The filters of the most recently used geometries, most recent first
+  using CachedFilter = std::pair<std::vector<double>, typename PhaseSymmetryFilterType::Pointer>;
+  std::list<CachedFilter> filters;
+  unsigned int            numberOfFilterBanks = 0;
+  ReadItem                item;
+  while (readQueue.Pop(item))
+  {
+    const ImagePointer image = item.second;
+    if (image.IsNull())
+    {
+      continue;
+    }
+    const std::string & inputFileName = inputFileNames[item.first];
+
+    std::vector<double>                   geometry;
+    const typename ImageType::SizeType    size = image->GetLargestPossibleRegion().GetSize();
+    const typename ImageType::SpacingType spacing = image->GetSpacing();
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      geometry.push_back(size[dim]);
+      geometry.push_back(spacing[dim]);
+    }
+
+    auto cached = std::find_if(
+      filters.begin(), filters.end(), [&geometry](const CachedFilter & filter) { return filter.first == geometry; });
+    const bool newGeometry = cached == filters.end();
+    if (newGeometry)
+    {
+      typename PhaseSymmetryFilterType::Pointer filter = PhaseSymmetryFilterType::New();
+      ConfigurePhaseSymmetryFilter(
+        filter.GetPointer(), wavelengths, orientations, sigma, angularBandwidth, polarity, noiseThreshold);
+      filters.emplace_front(geometry, filter);
+    }
+    else
+    {
+      filters.splice(filters.begin(), filters, cached);
+    }
+    PhaseSymmetryFilterType * phaseSymmetryFilter = filters.front().second;
+
+    ImagePointer output;
+    phaseSymmetryFilter->SetInput(image);
+    try
+    {
+      if (newGeometry)
+      {
+        phaseSymmetryFilter->Initialize();
+        ++numberOfFilterBanks;
+      }
+      phaseSymmetryFilter->Update();
+      output = phaseSymmetryFilter->GetOutput();
+      output->DisconnectPipeline();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      std::cerr << inputFileName << ": " << excp << std::endl;
+      ++failures;
+    }
+    phaseSymmetryFilter->SetInput(nullptr);
+    if (output.IsNull())
+    {
+      if (newGeometry)
+      {
+        filters.pop_front();
+      }
+      continue;
+    }
+    if (filters.size() > queueLength)
+    {
+      filters.pop_back();
+    }
+
+    writeQueue.Push(WriteItem(outputFileNames[item.first], output));
+  }
+  joinThreads.Run();
+
+  std::cout << inputFileNames.size() - failures << " of " << inputFileNames.size() << " images processed with "
+            << numberOfFilterBanks << " filter banks" << std::endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int
 main(int argc, char * argv[])
 {
   PARSE_ARGS;
 
+  // In batch mode, the first input decides the dimension of all of them
+  std::vector<std::string> inputFileNames;
+  if (batch)
+  {
+    inputFileNames = ExpandBatchInputs(inputImage);
+    if (inputFileNames.empty())
+    {
+      std::cerr << "No input matches " << inputImage << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  const std::string firstInput = batch ? inputFileNames[0] : inputImage;
+
   itk::ImageIOBase::Pointer imageIO =
-    itk::ImageIOFactory::CreateImageIO(inputImage.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+    itk::ImageIOFactory::CreateImageIO(firstInput.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
   if (imageIO.IsNull())
   {
-    std::cerr << "Could not create ImageIO for file: " << inputImage << std::endl;
+    std::cerr << "Could not create ImageIO for file: " << firstInput << std::endl;
     return EXIT_FAILURE;
   }
-  imageIO->SetFileName(inputImage);
+  imageIO->SetFileName(firstInput);
   imageIO->ReadImageInformation();
 
   const unsigned int dimension = imageIO->GetNumberOfDimensions();
   switch (dimension)
   {
     case 2:
-      return PhaseSymmetryFilter<2>(argc, argv);
+      return batch ? PhaseSymmetryFilterBatch<2>(inputFileNames, argc, argv) : PhaseSymmetryFilter<2>(argc, argv);
     case 3:
-      return PhaseSymmetryFilter<3>(argc, argv);
+      return batch ? PhaseSymmetryFilterBatch<3>(inputFileNames, argc, argv) : PhaseSymmetryFilter<3>(argc, argv);
     default:
       std::cerr << "Error: Unsupported image dimension." << std::endl;
       return EXIT_FAILURE;
@@ -0,0 +1,95 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryWorkloadImageSource.h"
+#include "itkImageFileWriter.h"
+#include "PhaseSymmetryWorkloadCLP.h"
+
+#include <algorithm>
+
+template <unsigned int VDimension>
+int
+PhaseSymmetryWorkload(int argc, char * argv[])
+{
+  PARSE_ARGS;
+
+  using PixelType = float;
+  const unsigned int Dimension = VDimension;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  if (spacing.size() != Dimension)
+  {
+    std::cerr << "Error: expected " << Dimension << " spacing values." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using SourceType = itk::PhaseSymmetryWorkloadImageSource<ImageType>;
+  typename SourceType::Pointer     source = SourceType::New();
+  typename SourceType::SizeType    imageSize;
+  typename SourceType::SpacingType imageSpacing;
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+  {
+    imageSize[dim] = size[dim];
+    imageSpacing[dim] = spacing[dim];
+  }
+  source->SetSize(imageSize);
+  source->SetSpacing(imageSpacing);
+  source->SetSeed(seed);
+  source->SetNumberOfSinusoids(numberOfSinusoids);
+  source->SetMinimumFrequency(minimumFrequency);
+  source->SetMaximumFrequency(maximumFrequency);
+  source->SetNumberOfSurfaces(numberOfSurfaces);
+  source->SetSpeckleLevel(speckleLevel);
+
+  // The source generates only the piece the writer requests
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(source->GetOutput());
+  writer->SetFileName(outputImage);
+  writer->SetNumberOfStreamDivisions(std::max(numberOfStreamDivisions, 1));
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int
+main(int argc, char * argv[])
+{
+  PARSE_ARGS;
+
+  switch (size.size())
+  {
+    case 2:
+      return PhaseSymmetryWorkload<2>(argc, argv);
+    case 3:
+      return PhaseSymmetryWorkload<3>(argc, argv);
+    default:
+      std::cerr << "Error: Unsupported image dimension." << std::endl;
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
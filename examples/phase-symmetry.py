@@ -19,7 +19,7 @@
 
 import itk
 import argparse
-import numpy as np
+from itk.phase_symmetry import phase_symmetry
 
 def run(input_image_file, output_image_file,
         wavelengths=None,
@@ -30,38 +30,16 @@ def run(input_image_file, output_image_file,
     boundary_condition = itk.PeriodicBoundaryCondition[type(input_image)]()
     padded = itk.fft_pad_image_filter(input_image, boundary_condition=boundary_condition)
 
-    dimension = input_image.GetImageDimension()
+    # The default orientations are the image axes
+    result = phase_symmetry(itk.array_view_from_image(padded),
+                            wavelengths=wavelengths,
+                            sigma=sigma,
+                            polarity=polarity,
+                            noise_threshold=noise_threshold,
+                            spacing=padded.GetSpacing())
 
-    phase_symmetry_filter = itk.PhaseSymmetryImageFilter.New(padded)
-
-    if wavelengths:
-        scales = len(wavelengths) / dimension
-        wavelength_matrix = itk.Array2D[itk.D](int(scales), dimension)
-        np_array = np.array(wavelengths, dtype=np.float64)
-        vnl_vector = itk.GetVnlVectorFromArray(np_array)
-        wavelength_matrix.copy_in(vnl_vector.data_block())
-        phase_symmetry_filter.SetWavelengths(wavelength_matrix)
-
-    if dimension == 2:
-        orientation_matrix = itk.Array2D[itk.D](2, dimension)
-        np_array = np.array([1, 0, 0, 1], dtype=np.float64)
-        vnl_vector = itk.GetVnlVectorFromArray(np_array)
-        orientation_matrix.copy_in(vnl_vector.data_block())
-        phase_symmetry_filter.SetOrientations(orientation_matrix)
-    else:
-        orientation_matrix = itk.Array2D[itk.D](3, dimension)
-        np_array = np.array([1, 0, 0, 0, 1, 0, 0, 0, 1], dtype=np.float64)
-        vnl_vector = itk.GetVnlVectorFromArray(np_array)
-        orientation_matrix.copy_in(vnl_vector.data_block())
-        phase_symmetry_filter.SetOrientations(orientation_matrix)
-
-    phase_symmetry_filter.SetSigma(sigma)
-    phase_symmetry_filter.SetPolarity(polarity)
-    phase_symmetry_filter.SetNoiseThreshold(noise_threshold)
-
-    phase_symmetry_filter.Initialize()
-
-    output_image = phase_symmetry_filter.GetOutput()
+    output_image = itk.image_view_from_array(result)
+    output_image.CopyInformation(padded)
     itk.imwrite(output_image, output_image_file, True)
 
 def main():
@@ -18,29 +18,31 @@
 #ifndef itkButterworthFilterFreqImageSource_h
 #define itkButterworthFilterFreqImageSource_h
 
-#include "itkGenerateImageSource.h"
+#include "itkRadialFrequencyImageSource.h"
 
 namespace itk
 {
 
 /** \class ButterworthFilterFreqImageSource
+ *
+ * \sa RadialFrequencyImageSource
  *
  * \ingroup PhaseSymmetry
  */
 template <typename TOutputImage>
-class ButterworthFilterFreqImageSource : public GenerateImageSource<TOutputImage>
+class ButterworthFilterFreqImageSource : public RadialFrequencyImageSource<TOutputImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_ASSIGN(ButterworthFilterFreqImageSource);
 
   /** Standard class type alias. */
   using Self = ButterworthFilterFreqImageSource;
-  using Superclass = GenerateImageSource<TOutputImage>;
+  using Superclass = RadialFrequencyImageSource<TOutputImage>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(ButterworthFilterFreqImageSource, GenerateImageSource);
+  itkTypeMacro(ButterworthFilterFreqImageSource, RadialFrequencyImageSource);
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -53,6 +55,8 @@ public:
   using PointType = typename TOutputImage::PointType;
   using DirectionType = typename TOutputImage::DirectionType;
   using SizeType = typename TOutputImage::SizeType;
+  using OutputImagePixelType = typename TOutputImage::PixelType;
+  using ArrayType = typename Superclass::ArrayType;
 
   /** Set/Get the cutoff frequency. Should be in the range [0, 0.5], where 0.5
    * corresponds to the Nyquist frequency. */
@@ -72,8 +76,12 @@ protected:
 
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
+
+  ArrayType
+  GetRadiusScales() const override;
+
   void
-  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+  EvaluateRadialProfile(const double * squaredRadii, OutputImagePixelType * values, SizeValueType count) const override;
 
 private:
   double m_Cutoff{ 0.4 };
@@ -20,7 +20,6 @@
 #define itkButterworthFilterFreqImageSource_hxx
 
 #include "itkButterworthFilterFreqImageSource.h"
-#include "itkImageRegionIteratorWithIndex.h"
 
 
 namespace itk
@@ -48,44 +47,29 @@ ButterworthFilterFreqImageSource<TOutputImage>::PrintSelf(std::ostream & os, Ind
 
 
 template <typename TOutputImage>
-void
-ButterworthFilterFreqImageSource<TOutputImage>::DynamicThreadedGenerateData(
-  const OutputImageRegionType & outputRegionForThread)
+typename ButterworthFilterFreqImageSource<TOutputImage>::ArrayType
+ButterworthFilterFreqImageSource<TOutputImage>::GetRadiusScales() const
 {
-  OutputImageType * outputPtr = this->GetOutput();
-  const SizeType    size = this->GetSize();
+  ArrayType scales;
+  scales.Fill(1.0);
+  return scales;
+}
 
-  typename OutputImageType::PointType centerPoint;
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-  {
-    centerPoint[ii] = double(size[ii]) / 2.0;
-  }
 
-  using OutputIteratorType = ImageRegionIteratorWithIndex<OutputImageType>;
-  OutputIteratorType outIt(outputPtr, outputRegionForThread);
-  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+template <typename TOutputImage>
+void
+ButterworthFilterFreqImageSource<TOutputImage>::EvaluateRadialProfile(const double *         squaredRadii,
+                                                                      OutputImagePixelType * values,
+                                                                      SizeValueType          count) const
+{
+  // (r / cutoff)^(2 order) == (r^2 / cutoff^2)^order, which spares the square
+  // root of the radius
+  const double inverseSquaredCutoff = 1.0 / (m_Cutoff * m_Cutoff);
+
+  for (SizeValueType ii = 0; ii < count; ++ii)
   {
-    const typename TOutputImage::IndexType index = outIt.GetIndex();
-    // std::cout << "index: " << index << std::endl;
-
-    double radius = 0.0;
-    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-    {
-      const double dist = (centerPoint[ii] - double(index[ii])) / double(size[ii]);
-      // %todo: is this correct for odd numbers?
-      // const SizeValueType halfLength = size[ii] / 2;
-      // const double dist = (index[ii] % halfLength) / double(halfLength);
-      radius += dist * dist;
-    }
-    radius = std::sqrt(radius);
-    // std::cout << "radius: " << radius << std::endl;
-
-    double value = 0.0;
-    value = radius / m_Cutoff;
-    value = std::pow(value, 2 * m_Order);
-    value = 1. / (1. + value);
-
-    outIt.Set(static_cast<typename TOutputImage::PixelType>(value));
+    const double value = 1. / (1. + std::pow(squaredRadii[ii] * inverseSquaredCutoff, m_Order));
+    values[ii] = static_cast<OutputImagePixelType>(value);
   }
 }
 
@@ -18,24 +18,26 @@
 #ifndef itkLogGaborFreqImageSource_h
 #define itkLogGaborFreqImageSource_h
 
-#include "itkGenerateImageSource.h"
+#include "itkRadialFrequencyImageSource.h"
 
 namespace itk
 {
 
 /** \class LogGaborFreqImageSource
+ *
+ * \sa RadialFrequencyImageSource
  *
  * \ingroup PhaseSymmetry
  */
 template <typename TOutputImage>
-class LogGaborFreqImageSource : public GenerateImageSource<TOutputImage>
+class LogGaborFreqImageSource : public RadialFrequencyImageSource<TOutputImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_ASSIGN(LogGaborFreqImageSource);
 
   /** Standard class type alias. */
   using Self = LogGaborFreqImageSource;
-  using Superclass = GenerateImageSource<TOutputImage>;
+  using Superclass = RadialFrequencyImageSource<TOutputImage>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
@@ -49,10 +51,11 @@ public:
   using PointType = typename TOutputImage::PointType;
   using DirectionType = typename TOutputImage::DirectionType;
 
-  using ArrayType = FixedArray<double, ImageDimension>;
+  using OutputImagePixelType = typename TOutputImage::PixelType;
+  using ArrayType = typename Superclass::ArrayType;
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(LogGaborFreqImageSource, GenerateImageSource);
+  itkTypeMacro(LogGaborFreqImageSource, RadialFrequencyImageSource);
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -70,8 +73,12 @@ protected:
   ~LogGaborFreqImageSource() override;
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
+
+  ArrayType
+  GetRadiusScales() const override;
+
   void
-  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+  EvaluateRadialProfile(const double * squaredRadii, OutputImagePixelType * values, SizeValueType count) const override;
 
 private:
   // Ratio of k/wo in each direction
@@ -19,7 +19,6 @@
 #define itkLogGaborFreqImageSource_hxx
 
 #include "itkLogGaborFreqImageSource.h"
-#include "itkImageRegionIteratorWithIndex.h"
 
 namespace itk
 {
@@ -50,52 +49,31 @@ LogGaborFreqImageSource<TOutputImage>::PrintSelf(std::ostream & os, Indent inden
 
 
 template <typename TOutputImage>
-void
-LogGaborFreqImageSource<TOutputImage>::DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread)
+typename LogGaborFreqImageSource<TOutputImage>::ArrayType
+LogGaborFreqImageSource<TOutputImage>::GetRadiusScales() const
 {
-  OutputImageType * outputPtr = this->GetOutput();
-  const SizeType    size = this->GetSize();
-
-  PointType centerPoint;
-  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-  {
-    centerPoint[ii] = double(size[ii]) / 2.0;
-  }
+  return m_Wavelengths;
+}
 
-  using OutputIteratorType = ImageRegionIteratorWithIndex<OutputImageType>;
-  OutputIteratorType outIt(outputPtr, outputRegionForThread);
 
+template <typename TOutputImage>
+void
+LogGaborFreqImageSource<TOutputImage>::EvaluateRadialProfile(const double *         squaredRadii,
+                                                             OutputImagePixelType * values,
+                                                             SizeValueType          count) const
+{
   double sigma = std::log(m_Sigma);
   sigma *= sigma;
   sigma *= 2;
+  // exp(-log(r)^2 / sigma) == exp(-log(r^2)^2 / (4 sigma)), which spares the
+  // square root of the radius
+  const double exponentScale = -1.0 / (4.0 * sigma);
 
-  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+  for (SizeValueType ii = 0; ii < count; ++ii)
   {
-    const typename OutputImageType::IndexType index = outIt.GetIndex();
-    // std::cout << "index: " << index << std::endl;
-
-    double radius = 0.0;
-    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
-    {
-      const double dist = (centerPoint[ii] - double(index[ii])) / double(size[ii]);
-      // %todo: is this correct for odd numbers?
-      // const SizeValueType halfLength = size[ii] / 2;
-      // const double dist = (index[ii] % halfLength) / double(halfLength);
-      radius += dist * dist * m_Wavelengths[ii] * m_Wavelengths[ii];
-    }
-    if (radius == 0.0)
-    {
-      outIt.Set(static_cast<typename TOutputImage::PixelType>(0.0));
-      continue;
-    }
-    radius = std::sqrt(radius);
-    // std::cout << "radius: " << radius << std::endl;
-
-    radius = std::log(radius);
-    radius *= radius;
-
-    double logGaborValue = std::exp(-radius / sigma);
-    outIt.Set(static_cast<typename TOutputImage::PixelType>(logGaborValue));
+    const double logRadius = std::log(squaredRadii[ii]);
+    const double logGaborValue = std::exp(logRadius * logRadius * exponentScale);
+    values[ii] = static_cast<OutputImagePixelType>(squaredRadii[ii] == 0.0 ? 0.0 : logGaborValue);
   }
 }
 
@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryAngularPolynomial_h
+#define itkPhaseSymmetryAngularPolynomial_h
+
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace itk
+{
+/** \class PhaseSymmetryAngularPolynomial
+ * \brief Error bounded polynomial approximation of the angular Gaussian
+ * exp(k angle^2) of the orientation kernels, as a function of the cosine of
+ * the angle.
+ *
+ * As a function of the cosine, the angular Gaussian has a square root
+ * singularity at -1. It is smooth in the cosine of the half angle,
+ * cos(angle / 2) = sqrt((1 + cos(angle)) / 2), so the approximation is a
+ * Chebyshev polynomial in that variable mapped to [-1, 1], which spares the
+ * acos and the exp of an exact evaluation.
+ *
+ * \ingroup PhaseSymmetry
+ */
+class PhaseSymmetryAngularPolynomial
+{
+public:
+  /** Fit the lowest degree polynomial whose maximum absolute error, checked
+   * densely over the angles, is at most tolerance. Returns false, and leaves
+   * the polynomial empty, if no degree up to 256 does. */
+  bool
+  Fit(double exponentScale, double tolerance)
+  {
+    // The angular Gaussian as a function of x in [-1, 1], where (x + 1) / 2
+    // is the cosine of the half angle
+    const auto angularGaussian = [exponentScale](double x) {
+      const double halfAngle = std::acos(std::max(-1.0, std::min(1.0, (x + 1.0) / 2.0)));
+      return std::exp(4.0 * halfAngle * halfAngle * exponentScale);
+    };
+
+    constexpr unsigned int maximumDegree = 256;
+    constexpr unsigned int numberOfChecks = 4000;
+    const double           pi = itk::Math::pi;
+    for (unsigned int degree = 4; degree <= maximumDegree; degree += 4)
+    {
+      // Chebyshev interpolation at the Chebyshev nodes
+      std::vector<double> values(degree);
+      for (unsigned int j = 0; j < degree; ++j)
+      {
+        values[j] = angularGaussian(std::cos(pi * (j + 0.5) / degree));
+      }
+      m_Coefficients.assign(degree, 0.0);
+      for (unsigned int k = 0; k < degree; ++k)
+      {
+        for (unsigned int j = 0; j < degree; ++j)
+        {
+          m_Coefficients[k] += values[j] * std::cos(pi * k * (j + 0.5) / degree);
+        }
+        m_Coefficients[k] *= 2.0 / degree;
+      }
+
+      double error = 0.0;
+      for (unsigned int j = 0; j <= numberOfChecks; ++j)
+      {
+        const double angle = pi * j / numberOfChecks;
+        error = std::max(error, std::abs(this->Evaluate(std::cos(angle)) - std::exp(angle * angle * exponentScale)));
+      }
+      if (error <= tolerance)
+      {
+        return true;
+      }
+    }
+    m_Coefficients.clear();
+    return false;
+  }
+
+  /** Number of coefficients of the fitted polynomial, zero if none is. */
+  unsigned int
+  GetNumberOfCoefficients() const
+  {
+    return static_cast<unsigned int>(m_Coefficients.size());
+  }
+
+  /** Evaluate the fitted polynomial at a cosine. */
+  double
+  Evaluate(double cosine) const
+  {
+    const double x = 2.0 * std::sqrt(std::max(0.0, (1.0 + cosine) / 2.0)) - 1.0;
+
+    // Clenshaw recurrence
+    double             b1 = 0.0;
+    double             b2 = 0.0;
+    const unsigned int degree = this->GetNumberOfCoefficients();
+    for (unsigned int k = degree - 1; k > 0; --k)
+    {
+      const double b0 = 2.0 * x * b1 - b2 + m_Coefficients[k];
+      b2 = b1;
+      b1 = b0;
+    }
+    return x * b1 - b2 + 0.5 * m_Coefficients[0];
+  }
+
+private:
+  std::vector<double> m_Coefficients;
+};
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryFilterBankImageSource_h
+#define itkPhaseSymmetryFilterBankImageSource_h
+
+#include "itkGenerateImageSource.h"
+#include "itkArray2D.h"
+#include "itkNumericTraits.h"
+#include "itkPhaseSymmetryAngularPolynomial.h"
+
+namespace itk
+{
+
+/** \class PhaseSymmetryFilterBankImageSource
+ * \brief Generate the whole phase symmetry filter bank in one traversal of
+ * frequency space.
+ *
+ * Entry (scale w, orientation o) of the bank is the product of the log Gabor
+ * kernel of the wavelengths of row w, a Butterworth low pass kernel, and the
+ * angular Gaussian of row o of the orientations. Every pixel computes its
+ * frequency, the radial factor of each scale and the angular factor of each
+ * orientation once, and writes all the entries, so that the bank is bound by
+ * the bandwidth of its writes rather than by pipeline passes.
+ *
+ * The entries are written in FFT layout: index i along an axis of size n
+ * holds the frequency i / n for i < (n + 1) / 2, and (i - n) / n otherwise.
+ *
+ * With FactorizedOutputs on, the outputs are the scale factors followed by
+ * the orientation factors instead of their products, in the same layout.
+ *
+ * \sa LogGaborFreqImageSource, ButterworthFilterFreqImageSource,
+ * SteerableFilterFreqImageSource
+ *
+ * \ingroup PhaseSymmetry
+ */
+template <typename TOutputImage>
+class PhaseSymmetryFilterBankImageSource : public GenerateImageSource<TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PhaseSymmetryFilterBankImageSource);
+
+  /** Standard class type alias. */
+  using Self = PhaseSymmetryFilterBankImageSource;
+  using Superclass = GenerateImageSource<TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Dimensionality of the output image */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  using OutputImageType = TOutputImage;
+  using OutputImagePixelType = typename TOutputImage::PixelType;
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using SizeType = typename TOutputImage::SizeType;
+
+  using MatrixType = Array2D<double>;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PhaseSymmetryFilterBankImageSource, GenerateImageSource);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set/Get the wavelengths of each scale, one row per scale. */
+  virtual void
+  SetWavelengths(const MatrixType & wavelengths);
+  itkGetConstReferenceMacro(Wavelengths, MatrixType);
+
+  /** Set/Get the orientations, one row per orientation. */
+  virtual void
+  SetOrientations(const MatrixType & orientations);
+  itkGetConstReferenceMacro(Orientations, MatrixType);
+
+  /** Set/Get the width of the log Gabor kernels. */
+  itkSetMacro(Sigma, double);
+  itkGetConstMacro(Sigma, double);
+
+  /** Set/Get the angular bandwidth of the orientation kernels. */
+  itkSetMacro(AngularBandwidth, double);
+  itkGetConstMacro(AngularBandwidth, double);
+
+  /** Set/Get the maximum absolute error of the angular Gaussian. Zero, the
+   * default, evaluates it exactly; see
+   * SteerableFilterFreqImageSource::SetAngularTolerance(). */
+  itkSetClampMacro(AngularTolerance, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(AngularTolerance, double);
+
+  /** Set/Get the cutoff frequency and the order of the low pass kernel. */
+  itkSetMacro(Cutoff, double);
+  itkGetConstMacro(Cutoff, double);
+  itkSetMacro(Order, double);
+  itkGetConstMacro(Order, double);
+
+  /** Set/Get whether the outputs are the scale and orientation factors
+   * rather than the entries of the bank. */
+  virtual void
+  SetFactorizedOutputs(bool factorized);
+  itkGetConstMacro(FactorizedOutputs, bool);
+  itkBooleanMacro(FactorizedOutputs);
+
+  /** Get the entry of a scale and an orientation. */
+  OutputImageType *
+  GetEntryOutput(unsigned int scale, unsigned int orientation);
+
+  /** Get a scale or an orientation factor, with FactorizedOutputs on. */
+  OutputImageType *
+  GetScaleFactorOutput(unsigned int scale);
+  OutputImageType *
+  GetOrientationFactorOutput(unsigned int orientation);
+
+protected:
+  PhaseSymmetryFilterBankImageSource();
+  ~PhaseSymmetryFilterBankImageSource() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  /** Create or remove outputs to match the parameters. */
+  void
+  UpdateNumberOfOutputs();
+
+private:
+  MatrixType m_Wavelengths;
+  MatrixType m_Orientations;
+  double     m_Sigma{ 1.0 };
+  double     m_AngularBandwidth{ itk::Math::pi };
+  double     m_AngularTolerance{ 0.0 };
+  double     m_Cutoff{ 0.4 };
+  double     m_Order{ 10.0 };
+  bool       m_FactorizedOutputs{ false };
+
+  bool                           m_UseAngularPolynomial{ false };
+  PhaseSymmetryAngularPolynomial m_AngularPolynomial;
+  double                         m_AngularPolynomialExponentScale{ 0.0 };
+  double                         m_AngularPolynomialTolerance{ 0.0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPhaseSymmetryFilterBankImageSource.hxx"
+#endif
+
+#endif
@@ -0,0 +1,357 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryFilterBankImageSource_hxx
+#define itkPhaseSymmetryFilterBankImageSource_hxx
+
+#include "itkPhaseSymmetryFilterBankImageSource.h"
+#include "itkImageScanlineIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace itk
+{
+
+template <typename TOutputImage>
+PhaseSymmetryFilterBankImageSource<TOutputImage>::PhaseSymmetryFilterBankImageSource()
+{
+  // One scale and one orientation, along the first axis
+  m_Wavelengths.SetSize(1, ImageDimension);
+  m_Wavelengths.fill(2.0);
+  m_Orientations.SetSize(1, ImageDimension);
+  m_Orientations.fill(0.0);
+  m_Orientations(0, 0) = 1.0;
+
+  this->UpdateNumberOfOutputs();
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Wavelengths: " << m_Wavelengths << std::endl;
+  os << indent << "Orientations: " << m_Orientations << std::endl;
+  os << indent << "Sigma: " << m_Sigma << std::endl;
+  os << indent << "AngularBandwidth: " << m_AngularBandwidth << std::endl;
+  os << indent << "AngularTolerance: " << m_AngularTolerance << std::endl;
+  os << indent << "Cutoff: " << m_Cutoff << std::endl;
+  os << indent << "Order: " << m_Order << std::endl;
+  os << indent << "FactorizedOutputs: " << m_FactorizedOutputs << std::endl;
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::SetWavelengths(const MatrixType & wavelengths)
+{
+  if (wavelengths.cols() != ImageDimension)
+  {
+    itkExceptionMacro(<< "The wavelengths have " << wavelengths.cols() << " columns instead of " << ImageDimension);
+  }
+  m_Wavelengths = wavelengths;
+  this->UpdateNumberOfOutputs();
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::SetOrientations(const MatrixType & orientations)
+{
+  if (orientations.cols() != ImageDimension)
+  {
+    itkExceptionMacro(<< "The orientations have " << orientations.cols() << " columns instead of " << ImageDimension);
+  }
+  m_Orientations = orientations;
+  this->UpdateNumberOfOutputs();
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::SetFactorizedOutputs(bool factorized)
+{
+  if (m_FactorizedOutputs != factorized)
+  {
+    m_FactorizedOutputs = factorized;
+    this->UpdateNumberOfOutputs();
+  }
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::UpdateNumberOfOutputs()
+{
+  const unsigned int scales = m_Wavelengths.rows();
+  const unsigned int orientations = m_Orientations.rows();
+  const unsigned int numberOfOutputs =
+    std::max(1u, m_FactorizedOutputs ? scales + orientations : scales * orientations);
+
+  this->SetNumberOfRequiredOutputs(numberOfOutputs);
+  this->SetNumberOfIndexedOutputs(numberOfOutputs);
+  for (unsigned int ii = 0; ii < numberOfOutputs; ++ii)
+  {
+    if (!this->GetOutput(ii))
+    {
+      this->SetNthOutput(ii, this->MakeOutput(ii));
+    }
+  }
+  this->Modified();
+}
+
+
+template <typename TOutputImage>
+typename PhaseSymmetryFilterBankImageSource<TOutputImage>::OutputImageType *
+PhaseSymmetryFilterBankImageSource<TOutputImage>::GetEntryOutput(unsigned int scale, unsigned int orientation)
+{
+  if (m_FactorizedOutputs || scale >= m_Wavelengths.rows() || orientation >= m_Orientations.rows())
+  {
+    itkExceptionMacro(<< "No entry output for scale " << scale << " and orientation " << orientation);
+  }
+  return this->GetOutput(scale * m_Orientations.rows() + orientation);
+}
+
+
+template <typename TOutputImage>
+typename PhaseSymmetryFilterBankImageSource<TOutputImage>::OutputImageType *
+PhaseSymmetryFilterBankImageSource<TOutputImage>::GetScaleFactorOutput(unsigned int scale)
+{
+  if (!m_FactorizedOutputs || scale >= m_Wavelengths.rows())
+  {
+    itkExceptionMacro(<< "No scale factor output for scale " << scale);
+  }
+  return this->GetOutput(scale);
+}
+
+
+template <typename TOutputImage>
+typename PhaseSymmetryFilterBankImageSource<TOutputImage>::OutputImageType *
+PhaseSymmetryFilterBankImageSource<TOutputImage>::GetOrientationFactorOutput(unsigned int orientation)
+{
+  if (!m_FactorizedOutputs || orientation >= m_Orientations.rows())
+  {
+    itkExceptionMacro(<< "No orientation factor output for orientation " << orientation);
+  }
+  return this->GetOutput(m_Wavelengths.rows() + orientation);
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const OutputImageType * output = this->GetOutput(0);
+  for (unsigned int ii = 1; ii < this->GetNumberOfIndexedOutputs(); ++ii)
+  {
+    this->GetOutput(ii)->CopyInformation(output);
+  }
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::BeforeThreadedGenerateData()
+{
+  if (m_Wavelengths.rows() == 0 || m_Orientations.rows() == 0)
+  {
+    itkExceptionMacro(<< "At least one scale and one orientation are required");
+  }
+
+  const double angularSigma = (m_AngularBandwidth / 2) / 1.1774;
+  const double exponentScale = -1.0 / (2 * angularSigma * angularSigma);
+
+  m_UseAngularPolynomial = false;
+  if (m_AngularTolerance <= 0.0)
+  {
+    return;
+  }
+  if (m_AngularPolynomialExponentScale != exponentScale || m_AngularPolynomialTolerance != m_AngularTolerance)
+  {
+    m_AngularPolynomialExponentScale = exponentScale;
+    m_AngularPolynomialTolerance = m_AngularTolerance;
+    if (!m_AngularPolynomial.Fit(exponentScale, m_AngularTolerance))
+    {
+      itkWarningMacro(<< "No polynomial meets the angular tolerance " << m_AngularTolerance
+                      << " for the angular bandwidth " << m_AngularBandwidth << "; evaluating exactly");
+    }
+  }
+  m_UseAngularPolynomial = m_AngularPolynomial.GetNumberOfCoefficients() > 0;
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryFilterBankImageSource<TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  using IndexType = typename OutputImageType::IndexType;
+
+  OutputImageType *           output = this->GetOutput(0);
+  const OutputImageRegionType largestRegion = output->GetLargestPossibleRegion();
+  const unsigned int          scales = m_Wavelengths.rows();
+  const unsigned int          orientations = m_Orientations.rows();
+  const unsigned int          numberOfOutputs = this->GetNumberOfIndexedOutputs();
+
+  // Frequency of an index along an axis, in FFT layout
+  const auto frequency = [&largestRegion](IndexValueType index, unsigned int axis) {
+    const auto size = static_cast<IndexValueType>(largestRegion.GetSize(axis));
+    const auto ii = index - largestRegion.GetIndex(axis);
+    return double(ii < (size + 1) / 2 ? ii : ii - size) / double(size);
+  };
+
+  // Unit orientations
+  MatrixType unitOrientations = m_Orientations;
+  for (unsigned int oo = 0; oo < orientations; ++oo)
+  {
+    double norm = 0.0;
+    for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+    {
+      norm += m_Orientations(oo, dd) * m_Orientations(oo, dd);
+    }
+    for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+    {
+      unitOrientations(oo, dd) /= std::sqrt(norm);
+    }
+  }
+
+  // exp(-log(r)^2 / (2 log(sigma)^2)) == exp(-log(r^2)^2 / (8 log(sigma)^2))
+  const double logSigma = std::log(m_Sigma);
+  const double logGaborExponentScale = -1.0 / (8.0 * logSigma * logSigma);
+  const double inverseSquaredCutoff = 1.0 / (m_Cutoff * m_Cutoff);
+  const double angularSigma = (m_AngularBandwidth / 2) / 1.1774;
+  const double angularExponentScale = -1.0 / (2 * angularSigma * angularSigma);
+
+  std::vector<OutputImagePixelType *> buffers(numberOfOutputs);
+  for (unsigned int ii = 0; ii < numberOfOutputs; ++ii)
+  {
+    buffers[ii] = this->GetOutput(ii)->GetBufferPointer();
+  }
+  std::vector<double> lineWeightedRadii(scales);
+  std::vector<double> lineDotProducts(orientations);
+  std::vector<double> scaleValues(scales);
+  std::vector<double> orientationValues(orientations);
+
+  const SizeValueType                    lineLength = outputRegionForThread.GetSize(0);
+  ImageScanlineIterator<OutputImageType> outIt(output, outputRegionForThread);
+  while (!outIt.IsAtEnd())
+  {
+    const IndexType index = outIt.GetIndex();
+
+    // Contributions of the axes other than the scanline axis
+    double lineRadius = 0.0;
+    std::fill(lineWeightedRadii.begin(), lineWeightedRadii.end(), 0.0);
+    std::fill(lineDotProducts.begin(), lineDotProducts.end(), 0.0);
+    for (unsigned int dd = 1; dd < ImageDimension; ++dd)
+    {
+      const double dist = frequency(index[dd], dd);
+      lineRadius += dist * dist;
+      for (unsigned int ww = 0; ww < scales; ++ww)
+      {
+        const double weightedDist = dist * m_Wavelengths(ww, dd);
+        lineWeightedRadii[ww] += weightedDist * weightedDist;
+      }
+      for (unsigned int oo = 0; oo < orientations; ++oo)
+      {
+        lineDotProducts[oo] += unitOrientations(oo, dd) * dist;
+      }
+    }
+
+    // The outputs share their buffered region, hence the offset of the line
+    const OffsetValueType lineOffset = output->ComputeOffset(index);
+    for (SizeValueType xx = 0; xx < lineLength; ++xx)
+    {
+      const double dist = frequency(index[0] + static_cast<IndexValueType>(xx), 0);
+      const double squaredRadius = lineRadius + dist * dist;
+
+      // The log Gabor kernels are zero at the zero frequency, where the
+      // direction is undefined
+      if (squaredRadius == 0.0)
+      {
+        for (unsigned int ii = 0; ii < numberOfOutputs; ++ii)
+        {
+          buffers[ii][lineOffset + xx] = NumericTraits<OutputImagePixelType>::ZeroValue();
+        }
+        if (m_FactorizedOutputs)
+        {
+          for (unsigned int oo = 0; oo < orientations; ++oo)
+          {
+            buffers[scales + oo][lineOffset + xx] = NumericTraits<OutputImagePixelType>::OneValue();
+          }
+        }
+        continue;
+      }
+
+      const double lowPass = 1.0 / (1.0 + std::pow(squaredRadius * inverseSquaredCutoff, m_Order));
+      for (unsigned int ww = 0; ww < scales; ++ww)
+      {
+        const double weightedDist = dist * m_Wavelengths(ww, 0);
+        const double logRadius = std::log(lineWeightedRadii[ww] + weightedDist * weightedDist);
+        scaleValues[ww] = std::exp(logRadius * logRadius * logGaborExponentScale) * lowPass;
+      }
+
+      const double inverseRadius = 1.0 / std::sqrt(squaredRadius);
+      for (unsigned int oo = 0; oo < orientations; ++oo)
+      {
+        const double cosine = (lineDotProducts[oo] + unitOrientations(oo, 0) * dist) * inverseRadius;
+        if (m_UseAngularPolynomial)
+        {
+          orientationValues[oo] = m_AngularPolynomial.Evaluate(cosine);
+        }
+        else
+        {
+          // Rounding may take the cosine out of [-1, 1]
+          const double angle = std::acos(std::max(-1.0, std::min(1.0, cosine)));
+          orientationValues[oo] = std::exp(angle * angle * angularExponentScale);
+        }
+      }
+
+      if (m_FactorizedOutputs)
+      {
+        for (unsigned int ww = 0; ww < scales; ++ww)
+        {
+          buffers[ww][lineOffset + xx] = static_cast<OutputImagePixelType>(scaleValues[ww]);
+        }
+        for (unsigned int oo = 0; oo < orientations; ++oo)
+        {
+          buffers[scales + oo][lineOffset + xx] = static_cast<OutputImagePixelType>(orientationValues[oo]);
+        }
+        continue;
+      }
+      for (unsigned int ww = 0; ww < scales; ++ww)
+      {
+        OutputImagePixelType * const * scaleBuffers = buffers.data() + ww * orientations;
+        for (unsigned int oo = 0; oo < orientations; ++oo)
+        {
+          const double entry = scaleValues[ww] * orientationValues[oo];
+          scaleBuffers[oo][lineOffset + xx] = static_cast<OutputImagePixelType>(entry);
+        }
+      }
+    }
+    outIt.NextLine();
+  }
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,247 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryFrameProcessor_h
+#define itkPhaseSymmetryFrameProcessor_h
+
+#include "itkPhaseSymmetryImageFilter.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+/** \class PhaseSymmetryFrameProcessor
+ * \brief Low latency phase symmetry of a stream of 2D frames of fixed size.
+ *
+ * The processing is defined by a PhaseSymmetryImageFilter, configured through
+ * GetFilter() before Start(). Start() builds the plan of the filter for the
+ * frame size and allocates every buffer and FFT plan up front; afterwards
+ * frames are processed by persistent threads without heap allocation.
+ *
+ * Frames are passed as pixel buffers of the frame size, x fastest. PushFrame()
+ * copies a frame into a bounded ring buffer, and PopResult() copies out the
+ * result of the oldest frame, in push order. The time from push to result is
+ * recorded in a latency histogram. Results have the frame size, divided by
+ * the decimation factor of the filter.
+ *
+ * The frame size must have prime factors 2, 3 and 5 only.
+ *
+ * \sa PhaseSymmetryImageFilter
+ *
+ * \ingroup PhaseSymmetry
+ */
+template <typename TInputPixel,
+          typename TOutputPixel = float,
+          typename TComputePixel = typename NumericTraits<TOutputPixel>::FloatType>
+class PhaseSymmetryFrameProcessor : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PhaseSymmetryFrameProcessor);
+
+  /** Standard class type alias. */
+  using Self = PhaseSymmetryFrameProcessor;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PhaseSymmetryFrameProcessor, Object);
+
+  static constexpr unsigned int ImageDimension = 2;
+
+  using InputPixelType = TInputPixel;
+  using OutputPixelType = TOutputPixel;
+  using ComputePixelType = TComputePixel;
+  using ComplexPixelType = std::complex<ComputePixelType>;
+
+  using InputImageType = Image<InputPixelType, ImageDimension>;
+  using OutputImageType = Image<OutputPixelType, ImageDimension>;
+  using FilterType = PhaseSymmetryImageFilter<InputImageType, OutputImageType, ComputePixelType>;
+  using PlanType = typename FilterType::PlanType;
+  using SizeType = typename InputImageType::SizeType;
+
+  /** Get the filter that defines the processing. Set its parameters before
+   * Start(); its input is managed by the processor. */
+  itkGetModifiableObjectMacro(Filter, FilterType);
+
+  /** Set/Get the size of the frames. */
+  itkSetMacro(FrameSize, SizeType);
+  itkGetConstReferenceMacro(FrameSize, SizeType);
+
+  /** Set/Get the number of frames the ring buffer holds, pushed but not yet
+   * popped. */
+  itkSetClampMacro(RingBufferLength, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(RingBufferLength, unsigned int);
+
+  /** Set/Get the number of threads that process a frame together. The
+   * orientations of the filter are divided between them. */
+  itkSetClampMacro(NumberOfThreads, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  /** Build the filter bank, allocate the buffers and start the processing
+   * threads. Throws if the frame size cannot be transformed. */
+  void
+  Start();
+
+  /** Stop the processing threads. Frames that are not processed yet are
+   * dropped. */
+  void
+  Stop();
+
+  /** Copy a frame into the ring buffer. Returns false, without blocking, when
+   * the ring buffer is full. */
+  bool
+  PushFrame(const InputPixelType * frame);
+
+  /** Copy the result of the oldest pushed frame into result. When wait is
+   * true, blocks until that result is ready; otherwise returns false if it
+   * is not ready. Also returns false when no frame is pending. */
+  bool
+  PopResult(OutputPixelType * result, bool wait = true);
+
+  /** Push a frame and wait for its result. */
+  bool
+  ProcessFrame(const InputPixelType * frame, OutputPixelType * result);
+
+  /** Get the latency, in seconds, from PushFrame() to the result being ready,
+   * below which the given fraction of the recorded frames fall. */
+  double
+  GetLatencyPercentile(double fraction) const;
+
+  double
+  GetLatencyP50() const
+  {
+    return this->GetLatencyPercentile(0.5);
+  }
+
+  double
+  GetLatencyP99() const
+  {
+    return this->GetLatencyPercentile(0.99);
+  }
+
+  /** Get the number of frames recorded in the latency histogram. */
+  SizeValueType
+  GetNumberOfProcessedFrames() const;
+
+  void
+  ResetLatencyHistogram();
+
+  /** Width, in seconds, and number of the bins of the latency histogram.
+   * Longer latencies are counted in the last bin. */
+  static constexpr double LatencyBinWidth = 1e-5;
+  static constexpr unsigned int NumberOfLatencyBins = 20000;
+
+protected:
+  PhaseSymmetryFrameProcessor();
+  ~PhaseSymmetryFrameProcessor() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  using Clock = std::chrono::steady_clock;
+
+  enum class SlotState
+  {
+    Free,
+    Pending,
+    Done
+  };
+
+  /** A frame of the ring buffer with its result. */
+  struct Slot
+  {
+    std::vector<InputPixelType>  Input;
+    std::vector<OutputPixelType> Output;
+    Clock::time_point            PushTime;
+    SlotState                    State{ SlotState::Free };
+  };
+
+  /** Take frames from the ring buffer and process them until stopped. */
+  void
+  ProcessingLoop();
+
+  /** Wait for work from the processing thread until stopped. */
+  void
+  WorkerLoop(unsigned int workerIndex);
+
+  /** Accumulate the amplitude and energy of the orientations of a worker. */
+  void
+  ProcessOrientations(unsigned int workerIndex);
+
+  /** Compute the phase symmetry of a frame. Returns false, leaving the
+   * output unset, when stopped before the workers finished the frame. */
+  bool
+  ProcessSlot(Slot & slot);
+
+  void
+  RecordLatency(double seconds);
+
+private:
+  typename FilterType::Pointer m_Filter;
+  SizeType                     m_FrameSize;
+  unsigned int                 m_RingBufferLength{ 4 };
+  unsigned int                 m_NumberOfThreads{ 1 };
+
+  // The buffers and FFT plan of each processing thread are a scratch of the
+  // plan
+  typename PlanType::ConstPointer             m_Plan;
+  SizeValueType                               m_NumberOfPixels{ 0 };
+  std::vector<ComplexPixelType>               m_Spectrum;
+  std::vector<typename PlanType::ScratchType> m_Workers;
+  std::vector<Slot>                           m_Slots;
+  std::atomic<bool>                           m_Running{ false };
+
+  // Ring buffer, guarded by m_RingMutex
+  std::mutex              m_RingMutex;
+  std::condition_variable m_FramePushed;
+  std::condition_variable m_ResultReady;
+  unsigned int            m_PushIndex{ 0 };
+  unsigned int            m_ProcessIndex{ 0 };
+  unsigned int            m_PopIndex{ 0 };
+
+  // Work distribution between the processing thread and the workers, guarded
+  // by m_WorkMutex
+  std::mutex               m_WorkMutex;
+  std::condition_variable  m_WorkStarted;
+  std::condition_variable  m_WorkFinished;
+  SizeValueType            m_WorkGeneration{ 0 };
+  unsigned int             m_WorkersRemaining{ 0 };
+  unsigned int             m_WorkersBusy{ 0 };
+  std::thread              m_ProcessingThread;
+  std::vector<std::thread> m_WorkerThreads;
+
+  // Latency histogram, guarded by m_LatencyMutex
+  mutable std::mutex         m_LatencyMutex;
+  std::vector<SizeValueType> m_LatencyHistogram;
+  SizeValueType              m_NumberOfLatencies{ 0 };
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPhaseSymmetryFrameProcessor.hxx"
+#endif
+
+#endif
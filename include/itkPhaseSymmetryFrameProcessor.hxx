@@ -0,0 +1,419 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryFrameProcessor_hxx
+#define itkPhaseSymmetryFrameProcessor_hxx
+
+#include "itkPhaseSymmetryFrameProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+constexpr double PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::LatencyBinWidth;
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+constexpr unsigned int PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::NumberOfLatencyBins;
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::PhaseSymmetryFrameProcessor()
+{
+  m_Filter = FilterType::New();
+  m_FrameSize.Fill(0);
+  m_LatencyHistogram.assign(NumberOfLatencyBins, 0);
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::~PhaseSymmetryFrameProcessor()
+{
+  this->Stop();
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::Start()
+{
+  this->Stop();
+
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    SizeValueType n = m_FrameSize[i];
+    for (SizeValueType factor : { 2, 3, 5 })
+    {
+      while (n > 1 && n % factor == 0)
+      {
+        n /= factor;
+      }
+    }
+    if (n != 1)
+    {
+      itkExceptionMacro(<< "Frame size " << m_FrameSize << " must have prime factors 2, 3 and 5 only");
+    }
+  }
+  m_NumberOfPixels = m_FrameSize[0] * m_FrameSize[1];
+
+  // Build the plan through the filter, on a frame of the right size
+  typename InputImageType::Pointer frame = InputImageType::New();
+  frame->SetRegions(m_FrameSize);
+  frame->Allocate();
+  frame->FillBuffer(NumericTraits<InputPixelType>::ZeroValue());
+  m_Filter->SetInput(frame);
+  m_Filter->Initialize();
+  m_Plan = m_Filter->GetPlan();
+
+  // Allocate every buffer of the steady state
+  m_Spectrum.assign(m_NumberOfPixels, ComplexPixelType());
+  const unsigned int numberOfThreads =
+    std::max(1u, std::min(m_NumberOfThreads, m_Plan->GetNumberOfDistinctOrientations()));
+  m_Workers.clear();
+  m_Workers.resize(numberOfThreads);
+  for (auto & worker : m_Workers)
+  {
+    m_Plan->AllocateScratch(worker);
+  }
+  m_Slots.clear();
+  m_Slots.resize(m_RingBufferLength);
+  for (auto & slot : m_Slots)
+  {
+    slot.Input.assign(m_NumberOfPixels, InputPixelType());
+    slot.Output.assign(m_Plan->GetNumberOfOutputPixels(), OutputPixelType());
+    slot.State = SlotState::Free;
+  }
+  m_PushIndex = 0;
+  m_ProcessIndex = 0;
+  m_PopIndex = 0;
+  m_WorkGeneration = 0;
+  m_WorkersRemaining = 0;
+  m_WorkersBusy = 0;
+
+  m_Running = true;
+  m_ProcessingThread = std::thread(&Self::ProcessingLoop, this);
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+  {
+    m_WorkerThreads.emplace_back(&Self::WorkerLoop, this, i);
+  }
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    m_Running = false;
+  }
+  m_FramePushed.notify_all();
+  m_ResultReady.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(m_WorkMutex);
+  }
+  m_WorkStarted.notify_all();
+  m_WorkFinished.notify_all();
+
+  if (m_ProcessingThread.joinable())
+  {
+    m_ProcessingThread.join();
+  }
+  for (auto & thread : m_WorkerThreads)
+  {
+    thread.join();
+  }
+  m_WorkerThreads.clear();
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+bool
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::PushFrame(const InputPixelType * frame)
+{
+  const Clock::time_point pushTime = Clock::now();
+
+  unsigned int index;
+  {
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    if (!m_Running || m_Slots[m_PushIndex].State != SlotState::Free)
+    {
+      return false;
+    }
+    index = m_PushIndex;
+  }
+
+  // The slot belongs to the caller until it is marked pending
+  Slot & slot = m_Slots[index];
+  std::copy(frame, frame + m_NumberOfPixels, slot.Input.begin());
+
+  {
+    std::lock_guard<std::mutex> lock(m_RingMutex);
+    slot.PushTime = pushTime;
+    slot.State = SlotState::Pending;
+    m_PushIndex = (m_PushIndex + 1) % m_RingBufferLength;
+  }
+  m_FramePushed.notify_one();
+  return true;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+bool
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::PopResult(OutputPixelType * result, bool wait)
+{
+  std::unique_lock<std::mutex> lock(m_RingMutex);
+  if (m_Slots.empty())
+  {
+    return false;
+  }
+  Slot & slot = m_Slots[m_PopIndex];
+  if (slot.State == SlotState::Free)
+  {
+    return false;
+  }
+  if (wait)
+  {
+    m_ResultReady.wait(lock, [this, &slot] { return slot.State == SlotState::Done || !m_Running; });
+  }
+  if (slot.State != SlotState::Done)
+  {
+    return false;
+  }
+  lock.unlock();
+
+  // The slot belongs to the caller until it is marked free
+  std::copy(slot.Output.begin(), slot.Output.end(), result);
+
+  lock.lock();
+  slot.State = SlotState::Free;
+  m_PopIndex = (m_PopIndex + 1) % m_RingBufferLength;
+  return true;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+bool
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::ProcessFrame(const InputPixelType * frame,
+                                                                                     OutputPixelType *      result)
+{
+  return this->PushFrame(frame) && this->PopResult(result, true);
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::ProcessingLoop()
+{
+  while (true)
+  {
+    Slot * slot;
+    {
+      std::unique_lock<std::mutex> lock(m_RingMutex);
+      m_FramePushed.wait(lock,
+                         [this] { return !m_Running || m_Slots[m_ProcessIndex].State == SlotState::Pending; });
+      if (!m_Running)
+      {
+        return;
+      }
+      slot = &m_Slots[m_ProcessIndex];
+    }
+
+    if (!this->ProcessSlot(*slot))
+    {
+      return;
+    }
+    this->RecordLatency(std::chrono::duration<double>(Clock::now() - slot->PushTime).count());
+
+    {
+      std::lock_guard<std::mutex> lock(m_RingMutex);
+      slot->State = SlotState::Done;
+      m_ProcessIndex = (m_ProcessIndex + 1) % m_RingBufferLength;
+    }
+    m_ResultReady.notify_all();
+  }
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::WorkerLoop(unsigned int workerIndex)
+{
+  SizeValueType generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_WorkMutex);
+      m_WorkStarted.wait(lock, [this, generation] { return !m_Running || m_WorkGeneration != generation; });
+      if (!m_Running)
+      {
+        return;
+      }
+      generation = m_WorkGeneration;
+      ++m_WorkersBusy;
+    }
+
+    this->ProcessOrientations(workerIndex);
+
+    {
+      std::lock_guard<std::mutex> lock(m_WorkMutex);
+      --m_WorkersRemaining;
+      --m_WorkersBusy;
+    }
+    m_WorkFinished.notify_one();
+  }
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+bool
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::ProcessSlot(Slot & slot)
+{
+  // Forward FFT of the frame, converted to the compute type
+  m_Plan->ForwardTransform(slot.Input.data(), m_Spectrum.data(), *m_Workers[0].Transform);
+
+  // The orientations are divided between the processing thread and the
+  // workers
+  {
+    std::lock_guard<std::mutex> lock(m_WorkMutex);
+    ++m_WorkGeneration;
+    m_WorkersRemaining = static_cast<unsigned int>(m_Workers.size()) - 1;
+  }
+  m_WorkStarted.notify_all();
+  this->ProcessOrientations(0);
+  {
+    // A worker that has not taken the frame when stopped never will, so after
+    // a stop only the workers still writing their accumulators are waited for
+    std::unique_lock<std::mutex> lock(m_WorkMutex);
+    m_WorkFinished.wait(lock, [this] { return m_WorkersRemaining == 0 || (!m_Running && m_WorkersBusy == 0); });
+    if (m_WorkersRemaining != 0)
+    {
+      return false;
+    }
+  }
+
+  // Sum the workers into the first, set negative values to zero and divide
+  // by the total amplitude
+  const SizeValueType numberOfOutputPixels = m_Plan->GetNumberOfOutputPixels();
+  ComputePixelType *  amplitude = m_Workers[0].Amplitude.data();
+  ComputePixelType *  energy = m_Workers[0].Energy.data();
+  for (std::size_t w = 1; w < m_Workers.size(); ++w)
+  {
+    for (SizeValueType i = 0; i < numberOfOutputPixels; ++i)
+    {
+      amplitude[i] += m_Workers[w].Amplitude[i];
+      energy[i] += m_Workers[w].Energy[i];
+    }
+  }
+  m_Plan->ComputeOutput(amplitude, energy, slot.Output.data(), 0, numberOfOutputPixels);
+  return true;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::ProcessOrientations(unsigned int workerIndex)
+{
+  typename PlanType::ScratchType & worker = m_Workers[workerIndex];
+  std::fill(worker.Amplitude.begin(), worker.Amplitude.end(), NumericTraits<ComputePixelType>::ZeroValue());
+  std::fill(worker.Energy.begin(), worker.Energy.end(), NumericTraits<ComputePixelType>::ZeroValue());
+
+  const unsigned int numberOfOrientations = m_Plan->GetNumberOfDistinctOrientations();
+  for (unsigned int o = workerIndex; o < numberOfOrientations; o += static_cast<unsigned int>(m_Workers.size()))
+  {
+    m_Plan->AccumulateOrientation(o, m_Spectrum.data(), worker.Amplitude.data(), worker.Energy.data(), worker);
+  }
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::RecordLatency(double seconds)
+{
+  const auto bin = static_cast<unsigned int>(
+    std::min(seconds / LatencyBinWidth, static_cast<double>(NumberOfLatencyBins - 1)));
+  std::lock_guard<std::mutex> lock(m_LatencyMutex);
+  ++m_LatencyHistogram[bin];
+  ++m_NumberOfLatencies;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+double
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::GetLatencyPercentile(double fraction) const
+{
+  std::lock_guard<std::mutex> lock(m_LatencyMutex);
+  if (m_NumberOfLatencies == 0)
+  {
+    return 0.0;
+  }
+  const auto    rank = static_cast<SizeValueType>(std::ceil(fraction * static_cast<double>(m_NumberOfLatencies)));
+  SizeValueType count = 0;
+  for (unsigned int bin = 0; bin < NumberOfLatencyBins; ++bin)
+  {
+    count += m_LatencyHistogram[bin];
+    if (count >= rank && count > 0)
+    {
+      return (bin + 1) * LatencyBinWidth;
+    }
+  }
+  return NumberOfLatencyBins * LatencyBinWidth;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+SizeValueType
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::GetNumberOfProcessedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_LatencyMutex);
+  return m_NumberOfLatencies;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::ResetLatencyHistogram()
+{
+  std::lock_guard<std::mutex> lock(m_LatencyMutex);
+  std::fill(m_LatencyHistogram.begin(), m_LatencyHistogram.end(), 0);
+  m_NumberOfLatencies = 0;
+}
+
+
+template <typename TInputPixel, typename TOutputPixel, typename TComputePixel>
+void
+PhaseSymmetryFrameProcessor<TInputPixel, TOutputPixel, TComputePixel>::PrintSelf(std::ostream & os,
+                                                                                 Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FrameSize: " << m_FrameSize << std::endl;
+  os << indent << "RingBufferLength: " << m_RingBufferLength << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "Running: " << m_Running << std::endl;
+  os << indent << "NumberOfProcessedFrames: " << this->GetNumberOfProcessedFrames() << std::endl;
+  os << indent << "LatencyP50: " << this->GetLatencyP50() << std::endl;
+  os << indent << "LatencyP99: " << this->GetLatencyP99() << std::endl;
+  os << indent << "Filter: " << std::endl;
+  m_Filter->Print(os, indent.GetNextIndent());
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryHalfFloat_h
+#define itkPhaseSymmetryHalfFloat_h
+
+#include "itkIntTypes.h"
+
+#include <cstring>
+
+namespace itk
+{
+/** \class PhaseSymmetryHalfFloat
+ * \brief Conversion between float and IEEE 754 binary16 (half precision)
+ * values stored as 16 bit unsigned integers.
+ *
+ * Half precision has a 10 bit mantissa and represents magnitudes from about
+ * 6e-8 to 65504. Conversion to half rounds to nearest even; values beyond the
+ * range become infinite.
+ *
+ * \ingroup PhaseSymmetry
+ */
+class PhaseSymmetryHalfFloat
+{
+public:
+  using StorageType = uint16_t;
+
+  static StorageType
+  FromFloat(float value)
+  {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t       magnitude = bits & 0x7fffffffu;
+
+    if (magnitude >= 0x7f800000u)
+    {
+      // Infinity or NaN
+      return static_cast<StorageType>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x0200u : 0u));
+    }
+    if (magnitude >= 0x477ff000u)
+    {
+      // Rounds beyond the largest half value
+      return static_cast<StorageType>(sign | 0x7c00u);
+    }
+    if (magnitude < 0x38800000u)
+    {
+      // Subnormal half or zero: adding 0.5 aligns the mantissa so that the
+      // float addition does the rounding
+      float magnitudeValue;
+      std::memcpy(&magnitudeValue, &magnitude, sizeof(magnitudeValue));
+      magnitudeValue += 0.5f;
+      std::memcpy(&magnitude, &magnitudeValue, sizeof(magnitude));
+      return static_cast<StorageType>(sign | (magnitude - 0x3f000000u));
+    }
+
+    // Normal half: rebias the exponent and round the mantissa to nearest even
+    const uint32_t mantissaIsOdd = (magnitude >> 13) & 1u;
+    magnitude += 0xc8000fffu + mantissaIsOdd;
+    return static_cast<StorageType>(sign | (magnitude >> 13));
+  }
+
+  static float
+  ToFloat(StorageType value)
+  {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    const uint32_t magnitude = value & 0x7fffu;
+    uint32_t       bits;
+    float          result;
+    if (magnitude >= 0x7c00u)
+    {
+      // Infinity or NaN
+      bits = sign | 0x7f800000u | ((magnitude & 0x03ffu) << 13);
+      std::memcpy(&result, &bits, sizeof(result));
+      return result;
+    }
+
+    // Shift into place and scale by 2^112 to rebias the exponent; this also
+    // normalizes subnormal halves
+    bits = magnitude << 13;
+    std::memcpy(&result, &bits, sizeof(result));
+    result *= 5.192296858534828e+33f;
+    std::memcpy(&bits, &result, sizeof(bits));
+    bits |= sign;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+};
+
+} // end namespace itk
+
+#endif
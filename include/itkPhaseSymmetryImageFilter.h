@@ -18,51 +18,267 @@
 #ifndef itkPhaseSymmetryImageFilter_h
 #define itkPhaseSymmetryImageFilter_h
 
-#include "itkFFTShiftImageFilter.h"
 #include "itkArray2D.h"
 #include "itkImageToImageFilter.h"
 #include "itkConceptChecking.h"
-#include "itkMultiplyImageFilter.h"
-#include "itkDivideImageFilter.h"
-#include "itkAddImageFilter.h"
-#include "itkSqrtImageFilter.h"
-#include "itkSquareImageFilter.h"
-#include "itkMaximumImageFilter.h"
-#include "itkExpImageFilter.h"
-#include "itkBoundedReciprocalImageFilter.h"
-#include "itkAtan2ImageFilter.h"
-#include "itkAcosImageFilter.h"
-#include "itkLogGaborFreqImageSource.h"
-#include "itkSteerableFilterFreqImageSource.h"
-#include "itkButterworthFilterFreqImageSource.h"
-#include "itkComposeImageFilter.h"
-#include "itkMagnitudeAndPhaseToComplexImageFilter.h"
-#include "itkImageAdaptor.h"
+#include "itkPhaseSymmetryFilterBankImageSource.h"
+#include "itkPhaseSymmetryHalfFloat.h"
+#include "itkPhaseSymmetryPlan.h"
+#include "itkPhaseSymmetrySharedMemory.h"
+#include "itkNumericTraits.h"
+#include "itkEventObject.h"
 #include "itkForwardFFTImageFilter.h"
 #include "itkComplexToComplexFFTImageFilter.h"
-#include "itkComplexToRealImageFilter.h"
-#include "itkComplexToPhaseImageFilter.h"
-#include "itkComplexToImaginaryImageFilter.h"
-#include "itkComplexToImaginaryImageFilter.h"
-#include "itkComplexToModulusImageFilter.h"
-#include "itkShiftScaleImageFilter.h"
-#include "itkAbsImageFilter.h"
+#include "itkVnlForwardFFTImageFilter.h"
+#include "itkVnlComplexToComplexFFTImageFilter.h"
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+#  include "itkFFTWForwardFFTImageFilter.h"
+#  include "itkFFTWComplexToComplexFFTImageFilter.h"
+#  include "itkFFTWCommon.h"
+#  include "itkFFTWGlobalConfiguration.h"
+#endif
 
 #include <vector>
 #include <complex>
+#include <string>
+#include <type_traits>
 
 namespace itk
 {
 
+/** \class PhaseSymmetryImageFilterEnums
+ * \brief Enums used by PhaseSymmetryImageFilter.
+ *
+ * \ingroup PhaseSymmetry
+ */
+class PhaseSymmetryImageFilterEnums
+{
+public:
+  /** \class FFTBackend
+   * \ingroup PhaseSymmetry
+   * FFT implementation used for the forward and inverse transforms. */
+  enum class FFTBackend : uint8_t
+  {
+    /** Whatever the ITK object factory provides. */
+    Default = 0,
+    VNL,
+    FFTW,
+    /** Measure the available implementations for the input size once, and
+     * reuse the fastest one from the tuning file afterwards. */
+    Autotune
+  };
+
+  /** \class FFTPlanRigor
+   * \ingroup PhaseSymmetry
+   * Planning effort of the FFTW backend, from cheapest to most thorough. */
+  enum class FFTPlanRigor : uint8_t
+  {
+    Estimate = 0,
+    Measure,
+    Patient,
+    Exhaustive
+  };
+
+  /** \class ProgressiveUpdates
+   * \ingroup PhaseSymmetry
+   * How often Update() delivers an intermediate result. */
+  enum class ProgressiveUpdates : uint8_t
+  {
+    Off = 0,
+    /** After the last scale of every distinct orientation. */
+    PerOrientation,
+    /** After every scale of every distinct orientation. */
+    PerScale
+  };
+};
+
+inline std::ostream &
+operator<<(std::ostream & out, const PhaseSymmetryImageFilterEnums::FFTBackend value)
+{
+  switch (value)
+  {
+    case PhaseSymmetryImageFilterEnums::FFTBackend::Default:
+      return out << "Default";
+    case PhaseSymmetryImageFilterEnums::FFTBackend::VNL:
+      return out << "VNL";
+    case PhaseSymmetryImageFilterEnums::FFTBackend::FFTW:
+      return out << "FFTW";
+    case PhaseSymmetryImageFilterEnums::FFTBackend::Autotune:
+      return out << "Autotune";
+  }
+  return out << "INVALID VALUE FOR PhaseSymmetryImageFilterEnums::FFTBackend";
+}
+
+inline std::ostream &
+operator<<(std::ostream & out, const PhaseSymmetryImageFilterEnums::FFTPlanRigor value)
+{
+  switch (value)
+  {
+    case PhaseSymmetryImageFilterEnums::FFTPlanRigor::Estimate:
+      return out << "Estimate";
+    case PhaseSymmetryImageFilterEnums::FFTPlanRigor::Measure:
+      return out << "Measure";
+    case PhaseSymmetryImageFilterEnums::FFTPlanRigor::Patient:
+      return out << "Patient";
+    case PhaseSymmetryImageFilterEnums::FFTPlanRigor::Exhaustive:
+      return out << "Exhaustive";
+  }
+  return out << "INVALID VALUE FOR PhaseSymmetryImageFilterEnums::FFTPlanRigor";
+}
+
+inline std::ostream &
+operator<<(std::ostream & out, const PhaseSymmetryImageFilterEnums::ProgressiveUpdates value)
+{
+  switch (value)
+  {
+    case PhaseSymmetryImageFilterEnums::ProgressiveUpdates::Off:
+      return out << "Off";
+    case PhaseSymmetryImageFilterEnums::ProgressiveUpdates::PerOrientation:
+      return out << "PerOrientation";
+    case PhaseSymmetryImageFilterEnums::ProgressiveUpdates::PerScale:
+      return out << "PerScale";
+  }
+  return out << "INVALID VALUE FOR PhaseSymmetryImageFilterEnums::ProgressiveUpdates";
+}
+
+/** \class PhaseSymmetryPartialResultEvent
+ * \brief Event invoked by PhaseSymmetryImageFilter when an intermediate
+ * result is available from GetPartialResult().
+ *
+ * GetIsFinal() is true for the last event of an Update(), whose result is
+ * the output itself.
+ *
+ * \ingroup PhaseSymmetry
+ */
+class PhaseSymmetryPartialResultEvent : public AnyEvent
+{
+public:
+  using Self = PhaseSymmetryPartialResultEvent;
+  using Superclass = AnyEvent;
+
+  explicit PhaseSymmetryPartialResultEvent(bool isFinal = false)
+    : m_IsFinal(isFinal)
+  {}
+  PhaseSymmetryPartialResultEvent(const Self & other)
+    : Superclass(other)
+    , m_IsFinal(other.m_IsFinal)
+  {}
+  ~PhaseSymmetryPartialResultEvent() override = default;
+  void
+  operator=(const Self &) = delete;
+
+  const char *
+  GetEventName() const override
+  {
+    return "PhaseSymmetryPartialResultEvent";
+  }
+  bool
+  CheckEvent(const EventObject * e) const override
+  {
+    return dynamic_cast<const Self *>(e) != nullptr;
+  }
+  EventObject *
+  MakeObject() const override
+  {
+    return new Self(m_IsFinal);
+  }
+
+  bool
+  GetIsFinal() const
+  {
+    return m_IsFinal;
+  }
+
+private:
+  bool m_IsFinal;
+};
+
+/** \class PhaseSymmetryFFTWTraits
+ * \brief Whether FFTW was enabled in ITK for a pixel precision, and access to
+ * its wisdom for that precision.
+ *
+ * \ingroup PhaseSymmetry
+ */
+template <typename TPixel>
+struct PhaseSymmetryFFTWTraits
+{
+  using Available = std::false_type;
+  static bool
+  ImportWisdom(const std::string &)
+  {
+    return false;
+  }
+  static bool
+  ExportWisdom(const std::string &)
+  {
+    return false;
+  }
+};
+
+#if defined(ITK_USE_FFTWF)
+template <>
+struct PhaseSymmetryFFTWTraits<float>
+{
+  using Available = std::true_type;
+  static bool
+  ImportWisdom(const std::string & path)
+  {
+    return FFTWGlobalConfiguration::ImportWisdomFileFloat(path);
+  }
+  static bool
+  ExportWisdom(const std::string & path)
+  {
+    return FFTWGlobalConfiguration::ExportWisdomFileFloat(path);
+  }
+};
+#endif
+
+#if defined(ITK_USE_FFTWD)
+template <>
+struct PhaseSymmetryFFTWTraits<double>
+{
+  using Available = std::true_type;
+  static bool
+  ImportWisdom(const std::string & path)
+  {
+    return FFTWGlobalConfiguration::ImportWisdomFileDouble(path);
+  }
+  static bool
+  ExportWisdom(const std::string & path)
+  {
+    return FFTWGlobalConfiguration::ExportWisdomFileDouble(path);
+  }
+};
+#endif
+
 /**
  * \class PhaseSymmetryImageFilter
  *
  * Phase congruency and feature type templated for an ndimensional image
  * See Peter Kovesi's site for details on the filter
  *
+ * The input may have any scalar pixel type, including integer types; it is
+ * converted to the floating point compute pixel type TComputePixel. The VNL
+ * transforms of the plan convert it as the forward FFT reads it, and the
+ * FFTW backend converts it into the spectrum buffer, where the transform
+ * runs in place; neither makes a converted copy of the input. Other FFT
+ * backends read a converted image of the compute type, which is released
+ * once the forward FFT has read it. By default the compute type is the
+ * floating point type of the output pixel type.
+ *
+ * The output may also have an integer pixel type, in which case the phase
+ * symmetry is clamped to [0, 1] and rescaled to [0, max] of that type by the
+ * pass that computes it.
+ *
+ * Initialize() builds an immutable PhaseSymmetryPlan, which GenerateData()
+ * executes, and which GetPlan() shares with callers that run it concurrently
+ * from their own threads without the pipeline.
+ *
  * \ingroup PhaseSymmetry
  */
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage,
+          typename TOutputImage,
+          typename TComputePixel = typename NumericTraits<typename TOutputImage::PixelType>::FloatType>
 class PhaseSymmetryImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
 {
 public:
@@ -89,13 +305,16 @@ public:
   using InputImageRegionType = typename InputImageType::RegionType;
   using InputImagePixelType = typename InputImageType::PixelType;
 
+  using InputImageSizeType = typename InputImageType::SizeType;
+
   using OutputImageType = TOutputImage;
   using OutputImagePointer = typename OutputImageType::Pointer;
   using OutputImageRegionType = typename OutputImageType::RegionType;
   using OutputImagePixelType = typename OutputImageType::PixelType;
 
-  using ComplexPixelComponentType = OutputImagePixelType;
-  using ImagePixelType = OutputImagePixelType;
+  using ComputePixelType = TComputePixel;
+  using ComplexPixelComponentType = ComputePixelType;
+  using ImagePixelType = ComputePixelType;
   using ComplexPixelType = std::complex<ComplexPixelComponentType>;
 
   using ArrayType = FixedArray<double, InputImageDimension>;
@@ -104,21 +323,299 @@ public:
 
   using FloatImageType = Image<ImagePixelType, InputImageDimension>;
 
+  using PlanType = PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>;
+
+  /** Dimension of the slices of slice-wise mode, which needs a volume. */
+  itkStaticConstMacro(SliceDimension,
+                      unsigned int,
+                      InputImageDimension > 2 ? InputImageDimension - 1 : InputImageDimension);
+  using SliceInputImageType = Image<InputImagePixelType, SliceDimension>;
+  using SliceOutputImageType = Image<OutputImagePixelType, SliceDimension>;
+  using SliceFilterType = PhaseSymmetryImageFilter<SliceInputImageType, SliceOutputImageType, TComputePixel>;
+
   itkSetMacro(Wavelengths, MatrixType);
+  itkGetConstReferenceMacro(Wavelengths, MatrixType);
   itkSetMacro(Orientations, MatrixType);
+  itkGetConstReferenceMacro(Orientations, MatrixType);
   itkSetMacro(AngleBandwidth, double);
+  itkGetConstMacro(AngleBandwidth, double);
   itkSetMacro(Sigma, double);
+  itkGetConstMacro(Sigma, double);
   itkSetMacro(NoiseThreshold, double);
+  itkGetConstMacro(NoiseThreshold, double);
   itkSetMacro(Polarity, int);
-
+  itkGetConstMacro(Polarity, int);
+
+  /** Set/Get the maximum absolute error of the angular part of the
+   * orientation kernels. Zero, the default, evaluates them exactly; see
+   * SteerableFilterFreqImageSource::SetAngularTolerance(). */
+  itkSetClampMacro(AngularTolerance, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(AngularTolerance, double);
+
+  /** Set/Get whether the orientations are folded onto the half-sphere whose
+   * first nonzero coordinate is positive, and unit directions within 1e-9 of
+   * one another or of their opposites are merged, so that directions that
+   * are equal or opposite up to rounding share their responses, as exactly
+   * equal or opposite ones always do; see GetNumberOfDistinctOrientations(). */
+  itkSetMacro(CanonicalizeOrientations, bool);
+  itkGetConstMacro(CanonicalizeOrientations, bool);
+  itkBooleanMacro(CanonicalizeOrientations);
+
+  /** Set/Get whether every scale x orientation entry of the filter bank is
+   * computed and stored by Initialize(). When off, only the per-scale and
+   * per-orientation factors are stored, and each entry is formed when it is
+   * needed. This trades one extra pass per entry for W x O fewer images. */
+  itkSetMacro(PrecomputeFilterBank, bool);
+  itkGetConstMacro(PrecomputeFilterBank, bool);
+  itkBooleanMacro(PrecomputeFilterBank);
+
+  /** Set/Get whether the entries of the precomputed filter bank are stored in
+   * half precision. The entries are smooth gains in [0, 1], for which half
+   * precision keeps a relative error below 5e-4; storing them so halves the
+   * memory of the bank and the bandwidth of the spectral products, which
+   * widen them back to the compute type. The input spectrum stays in the
+   * compute type, whose magnitudes exceed the range of half precision. */
+  itkSetMacro(HalfPrecisionFilterBank, bool);
+  itkGetConstMacro(HalfPrecisionFilterBank, bool);
+  itkBooleanMacro(HalfPrecisionFilterBank);
+
+  /** Set/Get the integer factor by which the output is decimated along every
+   * axis, for previews. With a factor f > 1 the output has the input size
+   * divided by f, with f times the spacing, and samples the full resolution
+   * result every f pixels: each band-passed spectrum is truncated to the
+   * frequencies of the output grid before its inverse FFT, so that the
+   * inverse FFTs and accumulation passes shrink by about f^D. Band-passed
+   * content above the Nyquist frequency of the output grid is lost, so that
+   * the preview is close to the full result for wavelengths well above 2f
+   * pixels. The default, 1, computes the full resolution. */
+  itkSetClampMacro(DecimationFactor, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(DecimationFactor, unsigned int);
+
+  /** Set/Get whether a volume is processed as independent slices of one
+   * dimension less, orthogonal to SliceAxis. Initialize() builds one filter
+   * bank and plan of the slice size from the wavelengths and orientations
+   * without their SliceAxis column; orientations along SliceAxis, which have
+   * no in-plane component, are left out. Update() runs the plan over the
+   * slices in parallel, with one scratch per work unit, reading the input
+   * and writing the output in place, and only over the slices of the
+   * requested region, so that the filter streams along SliceAxis. The slice
+   * size must have prime factors 2, 3 and 5 only. Decimation and shards are
+   * not supported in this mode, checkpoints are not written, and
+   * progressive updates deliver the final result only. */
+  itkSetMacro(SliceWise, bool);
+  itkGetConstMacro(SliceWise, bool);
+  itkBooleanMacro(SliceWise);
+
+  /** Set/Get the axis orthogonal to the slices of slice-wise mode. The
+   * default, the last axis, has contiguous slices. */
+  itkSetClampMacro(SliceAxis, unsigned int, 0, InputImageDimension - 1);
+  itkGetConstMacro(SliceAxis, unsigned int);
+
+  /** Set/Get a hard limit, in bytes, on the predicted peak memory of the
+   * filter. Zero, the default, disables the limit. If the requested filter
+   * bank strategy does not fit, Initialize() selects the one that needs less
+   * memory; if that does not fit either, Initialize() throws before any work
+   * is done. */
+  itkSetMacro(MemoryBudget, SizeValueType);
+  itkGetConstMacro(MemoryBudget, SizeValueType);
+
+  using FFTBackendEnum = PhaseSymmetryImageFilterEnums::FFTBackend;
+  using FFTPlanRigorEnum = PhaseSymmetryImageFilterEnums::FFTPlanRigor;
+
+  /** Set/Get the FFT implementation. VNL requires sizes with prime factors
+   * 2, 3 and 5 only; FFTW requires ITK to be built with FFTW for the pixel
+   * precision. The default uses whatever the object factory provides. */
+  itkSetMacro(FFTBackend, FFTBackendEnum);
+  itkGetConstMacro(FFTBackend, FFTBackendEnum);
+
+  /** Set/Get the planning effort of the FFTW backend. More thorough plans
+   * take longer to create and run faster; FFTW wisdom makes creating them
+   * again for the same size cheap. */
+  itkSetMacro(FFTPlanRigor, FFTPlanRigorEnum);
+  itkGetConstMacro(FFTPlanRigor, FFTPlanRigorEnum);
+
+  /** Set/Get the file in which the Autotune backend records the fastest
+   * backend and plan rigor for each input size and pixel precision. The FFTW
+   * wisdom is kept next to it, with the ".wisdom" suffix. Both are replaced
+   * by renaming, so that concurrent processes do not corrupt them. The
+   * tunings are also kept for the lifetime of the process, so that without a
+   * file a size is measured again only by filters that tune it concurrently. */
+  itkSetStringMacro(FFTTuningFileName);
+  itkGetStringMacro(FFTTuningFileName);
+
+  /** Set/Get the scratch file in which Update() checkpoints the amplitude and
+   * energy accumulated over the orientations completed so far. An Update()
+   * with the same input and parameters that finds a checkpoint resumes after
+   * the last orientation it records; a checkpoint of another run is ignored.
+   * The file is removed when Update() completes. Empty, the default, disables
+   * checkpoints. */
+  itkSetStringMacro(CheckpointFileName);
+  itkGetStringMacro(CheckpointFileName);
+
+  /** Set/Get the number of orientations completed between checkpoints. */
+  itkSetClampMacro(CheckpointInterval, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(CheckpointInterval, unsigned int);
+
+  /** Get the number of orientations the last Update() took from a
+   * checkpoint instead of computing them. */
+  itkGetConstMacro(NumberOfResumedOrientations, unsigned int);
+
+  using ProgressiveUpdatesEnum = PhaseSymmetryImageFilterEnums::ProgressiveUpdates;
+
+  /** Set/Get how often Update() invokes a PhaseSymmetryPartialResultEvent,
+   * for viewers that refine their display as the filter bank is processed.
+   * Each intermediate result is the energy accumulated so far, with the
+   * noise threshold of the orientations begun so far subtracted, divided by
+   * the amplitude accumulated so far, as the final pass computes it; listing
+   * the wavelengths from the longest gives coarse to fine results. The last
+   * event of an Update() is final, once the output is complete. The default,
+   * Off, invokes none. */
+  itkSetMacro(ProgressiveUpdates, ProgressiveUpdatesEnum);
+  itkGetConstMacro(ProgressiveUpdates, ProgressiveUpdatesEnum);
+
+  /** Set/Get the number of local processes that share the work of one job,
+   * and the shard of this process among them, from 0. Every process runs
+   * the filter with the same input and parameters and its own shard index.
+   * Shard 0 computes the input spectrum into the POSIX shared memory segment
+   * named by SetSharedMemoryName(), from which each shard computes a
+   * contiguous range of the scale x orientation entries of the filter bank;
+   * the shards then add their accumulators into the segment one at a time,
+   * and every shard computes the whole output from the sum. Processes of
+   * other containers take part when they share the /dev/shm of the host.
+   * The default, 1, runs the whole job in this process. Checkpoints are not
+   * supported with several shards, and the partial results of progressive
+   * updates are the final ones only. */
+  itkSetClampMacro(NumberOfShards, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfShards, unsigned int);
+  itkSetMacro(ShardIndex, unsigned int);
+  itkGetConstMacro(ShardIndex, unsigned int);
+
+  /** Set/Get the name of the shared memory segment of a sharded job, such
+   * as "/phase-symmetry-<job id>". It must be unique to the job: shard 0
+   * replaces a segment that a failed job left under the same name, and the
+   * name is removed once every shard has attached. */
+  itkSetStringMacro(SharedMemoryName);
+  itkGetStringMacro(SharedMemoryName);
+
+  /** Set/Get the identifier of this run of a sharded job, which must be
+   * nonzero and the same for every shard, and differ from that of any
+   * earlier run under the same shared memory name, such as the process id
+   * and start time of the launcher. Shards other than 0 only attach to the
+   * segment shard 0 created with it, never to one a failed run left. */
+  itkSetMacro(ShardRunIdentifier, uint64_t);
+  itkGetConstMacro(ShardRunIdentifier, uint64_t);
+
+  /** Set/Get the time in seconds a shard waits for the others at each step
+   * of a sharded job before it fails. */
+  itkSetClampMacro(ShardTimeout, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(ShardTimeout, double);
+
+  /** Get the result delivered by the PhaseSymmetryPartialResultEvent being
+   * invoked, with the output geometry, or null outside of one. The image is
+   * overwritten by the next event, so observers that keep it copy it. */
+  const OutputImageType *
+  GetPartialResult() const
+  {
+    return m_PartialResult.GetPointer();
+  }
+
+  /** \struct CostEstimateType
+   * \brief Predicted resources for one Initialize() and Update().
+   *
+   * \ingroup PhaseSymmetry
+   */
+  struct CostEstimateType
+  {
+    /** Predicted peak memory held by the input, output and filter, in bytes. */
+    SizeValueType PeakMemoryInBytes{ 0 };
+    /** Number of forward FFTs of the input. */
+    SizeValueType NumberOfForwardFFTs{ 0 };
+    /** Number of inverse FFTs of band-passed spectra. */
+    SizeValueType NumberOfInverseFFTs{ 0 };
+    /** Approximate number of floating point operations, counting a
+     * transcendental function as ten. */
+    double FloatingPointOperations{ 0.0 };
+    /** Whether the estimate is for the precomputed filter bank. */
+    bool PrecomputeFilterBank{ true };
+  };
+
+  /** Predict the resources needed to filter an image of the given size with
+   * the current parameters and the given filter bank strategy. */
+  CostEstimateType
+  EstimateCost(const InputImageSizeType & size, bool precomputeFilterBank) const;
+
+  /** Predict the resources needed for the current input, with the filter bank
+   * strategy that Initialize() selects under the current memory budget. The
+   * input information must be up to date. */
+  CostEstimateType
+  EstimateCost() const;
 
   void
   Initialize();
+
+  /** Get the filter bank entry for a scale and a distinct orientation, in
+   * FFT layout, as built by the last Initialize(): stored, widened from half
+   * precision, or composed from its factors. A stored entry is shared with
+   * the plan, and is read-only. */
+  typename FloatImageType::ConstPointer
+  GetFilterBankEntry(unsigned int scale, unsigned int orientation) const;
+
+  /** Get the number of distinct orientations of the filter bank built by the
+   * last Initialize(). For a real input, the band-passed response of the
+   * orientation -d is the complex conjugate of that of d, with the same
+   * amplitude and energy, so orientations whose unit directions are equal or
+   * opposite share one entry and one inverse FFT per scale, and their
+   * response is weighted by their number. On the Nyquist planes of an even
+   * size, where the bank is not exactly symmetric, the shared response
+   * neglects terms that the low-pass kernel attenuates a hundredfold. */
+  unsigned int
+  GetNumberOfDistinctOrientations() const
+  {
+    return static_cast<unsigned int>(m_OrientationMultiplicities.size());
+  }
+
+  /** Get the number of orientations a distinct orientation stands for. */
+  unsigned int
+  GetOrientationMultiplicity(unsigned int orientation) const
+  {
+    return m_OrientationMultiplicities[orientation];
+  }
+
+  /** Get the filter of the slices of slice-wise mode, as configured by the
+   * last Initialize(), or null. */
+  const SliceFilterType *
+  GetSliceFilter() const
+  {
+    return m_SliceFilter.GetPointer();
+  }
+
+  /** Get the plan built by the last Initialize(), or null before the first
+   * and in slice-wise mode, whose plan is that of GetSliceFilter().
+   * The plan is immutable, and its Execute() may be called concurrently with
+   * one scratch per thread; a later Initialize() builds a new plan and leaves
+   * this one intact. */
+  const PlanType *
+  GetPlan() const
+  {
+    return m_Plan.GetPointer();
+  }
+
+  /** Convert a phase symmetry value to the output pixel type: as is for a
+   * real output, clamped to [0, 1] and rescaled to [0, max] for an integer
+   * output. */
+  static OutputImagePixelType
+  ConvertToOutputPixel(ComputePixelType value)
+  {
+    return PlanType::ConvertToOutputPixel(value);
+  }
+
   /** Input and output images must be the same dimension, or the output's
   dimension must be one less than that of the input. */
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(ImageDimensionCheck, (Concept::SameDimension<InputImageDimension, OutputImageDimension>));
+  itkConceptMacro(InputConvertibleToComputeCheck, (Concept::Convertible<InputImagePixelType, ComputePixelType>));
+  itkConceptMacro(ComputeConvertibleToOutputCheck, (Concept::Convertible<ComputePixelType, OutputImagePixelType>));
   /** End concept checking */
 #endif
 
@@ -140,45 +637,179 @@ protected:
   void
   GenerateData() override;
 
-  static const int FFT_FORWARD = -1;
-  static const int FFT_BACKWARD = 1;
-
-  using FFTFilterType = ForwardFFTImageFilter<InputImageType>;
+  using FFTFilterType = ForwardFFTImageFilter<FloatImageType>;
   using ComplexImageType = typename FFTFilterType::OutputImageType;
   using IFFTFilterType = ComplexToComplexFFTImageFilter<ComplexImageType>;
 
-
   using FloatImageStack = std::vector<typename FloatImageType::Pointer>;
   using FloatImageBank = std::vector<FloatImageStack>;
 
-  using MultiplyImageFilterType = MultiplyImageFilter<FloatImageType, FloatImageType>;
-  using ComplexMultiplyImageFilterType = MultiplyImageFilter<ComplexImageType, ComplexImageType>;
-  using DivideImageFilterType = DivideImageFilter<FloatImageType, FloatImageType, FloatImageType>;
-  using AddImageFilterType = AddImageFilter<FloatImageType, FloatImageType>;
-  using SqrtImageFilterType = SqrtImageFilter<FloatImageType, FloatImageType>;
-  using SquareImageFilterType = SquareImageFilter<FloatImageType, FloatImageType>;
-  using MaxImageFilterType = MaximumImageFilter<FloatImageType, FloatImageType>;
-  using ExpImageFilterType = ExpImageFilter<FloatImageType, FloatImageType>;
-  using BoundedReciprocalImageFilterType = BoundedReciprocalImageFilter<FloatImageType, FloatImageType>;
-  using Atan2ImageFilterType = Atan2ImageFilter<FloatImageType, FloatImageType, FloatImageType>;
-  using AcosImageFilterType = AcosImageFilter<FloatImageType, FloatImageType>;
-
-
-  using LogGaborFreqImageSourceType = LogGaborFreqImageSource<FloatImageType>;
-  using SteerableFiltersFreqImageSourceType = SteerableFilterFreqImageSource<FloatImageType>;
-  using ButterworthKernelFreqImageSourceType = ButterworthFilterFreqImageSource<FloatImageType>;
-
-  using ShiftScaleImageFilterType = ShiftScaleImageFilter<FloatImageType, FloatImageType>;
-  using ComplexToRealFilterType = ComplexToRealImageFilter<ComplexImageType, FloatImageType>;
-  using ComplexToImaginaryFilterType = ComplexToImaginaryImageFilter<ComplexImageType, FloatImageType>;
-  using ComplexToModulusFilterType = ComplexToModulusImageFilter<ComplexImageType, FloatImageType>;
-  using ComplexToPhaseFilterType = ComplexToPhaseImageFilter<ComplexImageType, FloatImageType>;
-  using RealAndImaginaryToComplexFilterType = ComposeImageFilter<FloatImageType, ComplexImageType>;
-  using MagnitudeAndPhaseToComplexFilterType =
-    MagnitudeAndPhaseToComplexImageFilter<InputImageType, InputImageType, ComplexImageType>;
-  using ComplexFFTShiftImageFilterType = FFTShiftImageFilter<ComplexImageType, ComplexImageType>;
-  using DoubleFFTShiftImageFilterType = FFTShiftImageFilter<FloatImageType, FloatImageType>;
-  using AbsImageFilterType = AbsImageFilter<FloatImageType, FloatImageType>;
+  using HalfPixelType = PhaseSymmetryHalfFloat::StorageType;
+  using HalfImageType = Image<HalfPixelType, InputImageDimension>;
+  using HalfImageStack = std::vector<typename HalfImageType::Pointer>;
+  using HalfImageBank = std::vector<HalfImageStack>;
+
+  using FilterBankSourceType = PhaseSymmetryFilterBankImageSource<FloatImageType>;
+
+  /** Multiply a scale and an orientation factor, both in FFT layout, into
+   * one filter bank entry. */
+  typename FloatImageType::Pointer
+  ComposeFilterBankEntry(const FloatImageType * scaleFactor, const FloatImageType * orientationFactor) const;
+
+  /** Select whether the filter bank is precomputed for an input size: the
+   * requested strategy, unless it exceeds the memory budget and the other
+   * strategy needs less memory. */
+  bool
+  SelectPrecomputeFilterBank(const InputImageSizeType & size) const;
+
+  /** Create the forward and inverse FFT filters for the selected backend,
+   * tuning them for the input size when requested. */
+  void
+  CreateFFTFilters(const InputImageSizeType & size);
+
+  /** Create the FFT filters of a concrete backend and plan rigor. */
+  void
+  CreateFFTFilters(FFTBackendEnum backend, FFTPlanRigorEnum rigor);
+  void
+  CreateFFTWFilters(FFTPlanRigorEnum rigor, std::true_type);
+  void
+  CreateFFTWFilters(FFTPlanRigorEnum rigor, std::false_type);
+
+  /** Measure the candidate backends and plan rigors for an input size and
+   * return the fastest, reusing and updating the tuning file. */
+  void
+  AutotuneFFT(const InputImageSizeType & size, FFTBackendEnum & backend, FFTPlanRigorEnum & rigor);
+
+  /** Get the input as the input of the forward FFT filter: the input itself
+   * when it has the compute pixel type, or else a converted copy of the whole
+   * input, which lives until the forward FFT has read it. The VNL plan and
+   * the FFTW backend convert an input without such a copy. */
+  typename FloatImageType::ConstPointer
+  GetFFTInput(const InputImageType * input, std::true_type);
+  typename FloatImageType::ConstPointer
+  GetFFTInput(const InputImageType * input, std::false_type);
+
+  /** Whether FFTW can convert the input into its spectrum: it is available
+   * for the compute type, and the input has another pixel type. */
+  using FFTWConvertsInputType =
+    std::integral_constant<bool,
+                           PhaseSymmetryFFTWTraits<ComplexPixelComponentType>::Available::value &&
+                             !std::is_same<InputImageType, FloatImageType>::value>;
+
+  /** Whether the forward FFT filter is that of the FFTW backend, which then
+   * converts an input of another pixel type into its spectrum. */
+  bool
+  ConvertsInputInFFTWSpectrum(std::true_type) const;
+  bool
+  ConvertsInputInFFTWSpectrum(std::false_type) const
+  {
+    return false;
+  }
+
+  /** Compute the spectrum of the input with FFTW, at the plan rigor of the
+   * forward FFT filter. Each line of the input is converted into the
+   * spectrum buffer, padded as for an in-place real to complex transform,
+   * and the half spectrum it yields is then extended by Hermitian symmetry
+   * to the full spectrum. */
+  typename ComplexImageType::Pointer
+  ComputeFFTWSpectrum(const InputImageType * input, std::true_type);
+  typename ComplexImageType::Pointer
+  ComputeFFTWSpectrum(const InputImageType *, std::false_type)
+  {
+    return nullptr;
+  }
+
+  /** Create a zero image of the compute pixel type over the output region. */
+  typename FloatImageType::Pointer
+  CreateZeroImage() const;
+
+  /** Store a filter bank entry in half precision. */
+  typename HalfImageType::Pointer
+  ConvertToHalfPrecision(const FloatImageType * entry);
+
+  /** Configure the filter of the slices of slice-wise mode, with the slice
+   * geometry and parameters, and build its plan. */
+  void
+  InitializeSlices();
+
+  /** Run the plan of the slice filter over the slices of the requested
+   * region into the output. */
+  void
+  GenerateSlices();
+
+  /** Build the plan of the filter bank of the last Initialize(). */
+  void
+  BuildPlan(const InputImageSizeType & size);
+
+  static ComputePixelType
+  WidenFilterBankValue(ComputePixelType value)
+  {
+    return value;
+  }
+  static ComputePixelType
+  WidenFilterBankValue(HalfPixelType value)
+  {
+    return static_cast<ComputePixelType>(PhaseSymmetryHalfFloat::ToFloat(value));
+  }
+
+  /** Run a function over [begin, end) ranges that split a buffer of count
+   * pixels between the work units of the multi-threader. */
+  template <typename TFunction>
+  void
+  ParallelizeBuffer(SizeValueType count, TFunction function);
+
+  /** Compute the partial result from accumulators over the output region
+   * and invoke a PhaseSymmetryPartialResultEvent that is not final. */
+  void
+  InvokePartialResult(const ComputePixelType * amplitude, const ComputePixelType * energy);
+
+  /** Add the accumulators of this shard into those of the shared memory,
+   * after the shards that finished earlier, and replace them with the sum
+   * of all the shards once the last one has added its own. */
+  void
+  ReduceShards(PhaseSymmetrySharedMemory & shared,
+               SizeValueType               accumulatorOffset,
+               ComputePixelType *          amplitude,
+               ComputePixelType *          energy,
+               SizeValueType               count);
+
+  /** Hash of the input pixels and geometry and of every parameter that
+   * affects the accumulators, which identifies the checkpoints of a run and
+   * the shards of a job. The pixels are hashed by 64 bit words. */
+  uint64_t
+  ComputeCheckpointFingerprint(const InputImageType * input) const;
+
+  /** Load the accumulators from a checkpoint with the given fingerprint and
+   * return the number of orientations it completes, or 0 when there is none. */
+  unsigned int
+  ReadCheckpoint(uint64_t fingerprint, FloatImageType * amplitude, FloatImageType * energy) const;
+
+  /** Replace the checkpoint with the accumulators after the given number of
+   * completed orientations. */
+  void
+  WriteCheckpoint(uint64_t               fingerprint,
+                  unsigned int           completedOrientations,
+                  const FloatImageType * amplitude,
+                  const FloatImageType * energy) const;
+
+  /** Rename source over destination, removing the destination first where the
+   * platform cannot rename over an existing file. */
+  static bool
+  ReplaceFile(const std::string & source, const std::string & destination);
+
+  /** Compute the distinct orientations, as rows of m_Orientations, negated
+   * when they are folded, and the number of orientations each stands for. */
+  void
+  ComputeDistinctOrientations(MatrixType & distinctOrientations, std::vector<unsigned int> & multiplicities) const;
+
+  /** 64 bit FNV-1a hash of a byte range, continued from hash. */
+  static uint64_t
+  HashBytes(uint64_t hash, const void * data, SizeValueType count);
+
+  /** Hash of a range mixed by 64 bit words, and by bytes for its tail,
+   * continued from hash. */
+  static uint64_t
+  HashWords(uint64_t hash, const void * data, SizeValueType count);
 
 private:
   MatrixType m_Wavelengths;
@@ -188,32 +819,51 @@ private:
   double m_Sigma;
   double m_NoiseThreshold;
   int    m_Polarity;
+  double m_AngularTolerance{ 0.0 };
+  bool   m_CanonicalizeOrientations{ false };
+
+  unsigned int m_DecimationFactor{ 1 };
+
+  bool                              m_SliceWise{ false };
+  unsigned int                      m_SliceAxis{ InputImageDimension - 1 };
+  typename SliceFilterType::Pointer m_SliceFilter;
+
+  bool          m_PrecomputeFilterBank{ true };
+  bool          m_FilterBankIsPrecomputed{ true };
+  bool          m_HalfPrecisionFilterBank{ false };
+  SizeValueType m_MemoryBudget{ 0 };
+
+  FFTBackendEnum   m_FFTBackend{ FFTBackendEnum::Default };
+  FFTPlanRigorEnum m_FFTPlanRigor{ FFTPlanRigorEnum::Estimate };
+  std::string      m_FFTTuningFileName;
+
+  std::string  m_CheckpointFileName;
+  unsigned int m_CheckpointInterval{ 1 };
+  unsigned int m_NumberOfResumedOrientations{ 0 };
+
+  ProgressiveUpdatesEnum m_ProgressiveUpdates{ ProgressiveUpdatesEnum::Off };
+  OutputImagePointer     m_PartialResult;
 
-  typename MultiplyImageFilterType::Pointer m_MultiplyImageFilter;
-  typename DivideImageFilterType::Pointer   m_DivideImageFilter;
-  typename AddImageFilterType::Pointer      m_AddImageFilter;
-  typename AddImageFilterType::Pointer      m_AddImageFilter2;
-  typename MaxImageFilterType::Pointer      m_MaxImageFilter;
-  typename Atan2ImageFilterType::Pointer    m_AtanImageFilter;
-  typename AcosImageFilterType::Pointer     m_AcosImageFilter;
+  unsigned int m_NumberOfShards{ 1 };
+  unsigned int m_ShardIndex{ 0 };
+  std::string  m_SharedMemoryName;
+  uint64_t     m_ShardRunIdentifier{ 0 };
+  double       m_ShardTimeout{ 600.0 };
 
+  // Used by GenerateData() for backends other than VNL, whose transforms the
+  // plan carries out itself
   typename FFTFilterType::Pointer  m_FFTFilter;
   typename IFFTFilterType::Pointer m_IFFTFilter;
 
-  typename ShiftScaleImageFilterType::Pointer            m_ShiftScaleFilter;
-  typename ShiftScaleImageFilterType::Pointer            m_NegateFilter;
-  typename ShiftScaleImageFilterType::Pointer            m_NegateFilter2;
-  typename ComplexToRealFilterType::Pointer              m_C2RFilter;
-  typename ComplexToImaginaryFilterType::Pointer         m_C2IFilter;
-  typename ComplexToModulusFilterType::Pointer           m_C2MFilter;
-  typename ComplexToPhaseFilterType::Pointer             m_C2AFilter;
-  typename AbsImageFilterType::Pointer                   m_AbsImageFilter;
-  typename AbsImageFilterType::Pointer                   m_AbsImageFilter2;
-  typename MagnitudeAndPhaseToComplexFilterType::Pointer m_MP2CFilter;
+  MatrixType                m_DistinctOrientations;
+  std::vector<unsigned int> m_OrientationMultiplicities;
 
-  typename FloatImageType::Pointer m_PhaseSymmetry;
+  FloatImageBank  m_FilterBank;
+  HalfImageBank   m_HalfFilterBank;
+  FloatImageStack m_ScaleFactors;
+  FloatImageStack m_OrientationFactors;
 
-  FloatImageBank m_FilterBank;
+  typename PlanType::ConstPointer m_Plan;
 };
 
 } // end namespace itk
@@ -20,41 +20,29 @@
 #define itkPhaseSymmetryImageFilter_hxx
 
 #include "itkPhaseSymmetryImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itksys/SystemInformation.hxx"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
 
 namespace itk
 {
 
-template <typename TInputImage, typename TOutputImage>
-PhaseSymmetryImageFilter<TInputImage, TOutputImage>::PhaseSymmetryImageFilter()
-{
-  m_MultiplyImageFilter = MultiplyImageFilterType::New();
-  m_DivideImageFilter = DivideImageFilterType::New();
-  m_AddImageFilter = AddImageFilterType::New();
-  m_AddImageFilter2 = AddImageFilterType::New();
-  m_MaxImageFilter = MaxImageFilterType::New();
-  m_AtanImageFilter = Atan2ImageFilterType::New();
-  m_ShiftScaleFilter = ShiftScaleImageFilterType::New();
-  m_NegateFilter = ShiftScaleImageFilterType::New();
-  m_NegateFilter2 = ShiftScaleImageFilterType::New();
-  m_AcosImageFilter = AcosImageFilterType::New();
-  m_C2RFilter = ComplexToRealFilterType::New();
-  m_C2IFilter = ComplexToImaginaryFilterType::New();
-  m_C2MFilter = ComplexToModulusFilterType::New();
-  m_C2AFilter = ComplexToPhaseFilterType::New();
-  m_AbsImageFilter = AbsImageFilterType::New();
-  m_AbsImageFilter2 = AbsImageFilterType::New();
-  m_MP2CFilter = MagnitudeAndPhaseToComplexFilterType::New();
-
-  m_FFTFilter = FFTFilterType::New();
-  m_IFFTFilter = IFFTFilterType::New();
-
-  m_NegateFilter->SetScale(-1.0);
-  m_NegateFilter->SetShift(0.0);
-
-  m_NegateFilter2->SetScale(-1.0);
-  m_NegateFilter2->SetShift(0.0);
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::PhaseSymmetryImageFilter()
+{
+  this->CreateFFTFilters(FFTBackendEnum::Default, FFTPlanRigorEnum::Estimate);
 
   // Create 2 initialze wavelengths
   m_Wavelengths.SetSize(2, InputImageDimension);
@@ -92,341 +80,1694 @@ PhaseSymmetryImageFilter<TInputImage, TOutputImage>::PhaseSymmetryImageFilter()
 }
 
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
 void
-PhaseSymmetryImageFilter<TInputImage, TOutputImage>::Initialize()
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::Initialize()
 {
   typename TInputImage::SizeType          inputSize;
-  typename TInputImage::IndexType         inputIndex;
-  typename Superclass::OutputImagePointer output = this->GetOutput();
   typename Superclass::InputImagePointer  input = const_cast<TInputImage *>(this->GetInput());
 
-  inputIndex = input->GetLargestPossibleRegion().GetIndex();
   inputSize = input->GetLargestPossibleRegion().GetSize();
   constexpr unsigned int ndims = TInputImage::ImageDimension;
 
-  m_ShiftScaleFilter->SetInput(input);
-  m_ShiftScaleFilter->SetScale(0.0);
-  m_ShiftScaleFilter->SetShift(0.0);
+  // Slices have a bank and plan of their own, held by the slice filter
+  m_SliceFilter = nullptr;
+  if (m_SliceWise)
+  {
+    m_Plan = nullptr;
+    this->InitializeSlices();
+    return;
+  }
 
-  typename LogGaborFreqImageSourceType::Pointer         LogGaborKernel = LogGaborFreqImageSourceType::New();
-  typename SteerableFiltersFreqImageSourceType::Pointer SteerableFilterKernel =
-    SteerableFiltersFreqImageSourceType::New();
-  typename ButterworthKernelFreqImageSourceType::Pointer ButterworthFilterKernel =
-    ButterworthKernelFreqImageSourceType::New();
+  this->ComputeDistinctOrientations(m_DistinctOrientations, m_OrientationMultiplicities);
 
-  // Initialize log gabor kernels
-  LogGaborKernel->SetOrigin(this->GetInput()->GetOrigin());
-  LogGaborKernel->SetSpacing(this->GetInput()->GetSpacing());
-  LogGaborKernel->SetDirection(this->GetInput()->GetDirection());
-  LogGaborKernel->SetSize(inputSize);
+  // Select the filter bank strategy before any work is done, so that a job
+  // which cannot fit its memory budget fails immediately
+  m_FilterBankIsPrecomputed = this->SelectPrecomputeFilterBank(inputSize);
+  const CostEstimateType cost = this->EstimateCost(inputSize, m_FilterBankIsPrecomputed);
+  if (m_MemoryBudget > 0 && cost.PeakMemoryInBytes > m_MemoryBudget)
+  {
+    itkExceptionMacro(<< "Input of size " << inputSize << " needs an estimated " << cost.PeakMemoryInBytes
+                      << " bytes with the most memory-frugal strategy, which exceeds the memory budget of "
+                      << m_MemoryBudget << " bytes");
+  }
 
-  // Initialize directionality kernels
-  SteerableFilterKernel->SetOrigin(this->GetInput()->GetOrigin());
-  SteerableFilterKernel->SetSpacing(this->GetInput()->GetSpacing());
-  SteerableFilterKernel->SetDirection(this->GetInput()->GetDirection());
-  SteerableFilterKernel->SetSize(inputSize);
+  m_FilterBank.clear();
+  m_HalfFilterBank.clear();
+  m_ScaleFactors.clear();
+  m_OrientationFactors.clear();
+
+  this->CreateFFTFilters(inputSize);
+
+  // One traversal of frequency space writes the whole bank, or its factors,
+  // in FFT layout
+  typename FilterBankSourceType::Pointer filterBankSource = FilterBankSourceType::New();
+  filterBankSource->SetSize(inputSize);
+  filterBankSource->SetStartIndex(input->GetLargestPossibleRegion().GetIndex());
+  filterBankSource->SetOrigin(input->GetOrigin());
+  filterBankSource->SetSpacing(input->GetSpacing());
+  filterBankSource->SetDirection(input->GetDirection());
+  filterBankSource->SetWavelengths(m_Wavelengths);
+  filterBankSource->SetOrientations(m_DistinctOrientations);
+  filterBankSource->SetSigma(m_Sigma);
+  filterBankSource->SetAngularBandwidth(m_AngleBandwidth);
+  filterBankSource->SetAngularTolerance(m_AngularTolerance);
+  filterBankSource->SetCutoff(0.4);
+  filterBankSource->SetOrder(10.0);
+  filterBankSource->SetFactorizedOutputs(!m_FilterBankIsPrecomputed);
+
+  if (m_FilterBankIsPrecomputed && m_HalfPrecisionFilterBank)
+  {
+    // Generate one scale at a time, so that only the entries of that scale
+    // are held in the compute type before they are stored in half precision
+    MatrixType wavelength(1, ndims);
+    for (unsigned int w = 0; w < m_Wavelengths.rows(); w++)
+    {
+      wavelength.set_row(0, m_Wavelengths.get_row(w));
+      filterBankSource->SetWavelengths(wavelength);
+      filterBankSource->Update();
 
-  // Initialize low pass filter kernel
-  ButterworthFilterKernel->SetOrigin(this->GetInput()->GetOrigin());
-  ButterworthFilterKernel->SetSpacing(this->GetInput()->GetSpacing());
-  ButterworthFilterKernel->SetDirection(this->GetInput()->GetDirection());
-  ButterworthFilterKernel->SetSize(inputSize);
-  ButterworthFilterKernel->SetCutoff(0.4);
-  ButterworthFilterKernel->SetOrder(10.0);
+      HalfImageStack halfStack;
+      for (unsigned int o = 0; o < m_DistinctOrientations.rows(); o++)
+      {
+        halfStack.push_back(this->ConvertToHalfPrecision(filterBankSource->GetEntryOutput(0, o)));
+      }
+      m_HalfFilterBank.push_back(halfStack);
+    }
+  }
+  else if (m_FilterBankIsPrecomputed)
+  {
+    filterBankSource->Update();
+    for (unsigned int w = 0; w < m_Wavelengths.rows(); w++)
+    {
+      FloatImageStack entryStack;
+      for (unsigned int o = 0; o < m_DistinctOrientations.rows(); o++)
+      {
+        entryStack.push_back(filterBankSource->GetEntryOutput(w, o));
+      }
+      m_FilterBank.push_back(entryStack);
+    }
+    for (auto & entryStack : m_FilterBank)
+    {
+      for (auto & entry : entryStack)
+      {
+        entry->DisconnectPipeline();
+      }
+    }
+  }
+  else
+  {
+    // Keep the factors only; the entries are composed in GenerateData
+    filterBankSource->Update();
+    for (unsigned int w = 0; w < m_Wavelengths.rows(); w++)
+    {
+      m_ScaleFactors.push_back(filterBankSource->GetScaleFactorOutput(w));
+    }
+    for (unsigned int o = 0; o < m_DistinctOrientations.rows(); o++)
+    {
+      m_OrientationFactors.push_back(filterBankSource->GetOrientationFactorOutput(o));
+    }
+    for (auto & factor : m_ScaleFactors)
+    {
+      factor->DisconnectPipeline();
+    }
+    for (auto & factor : m_OrientationFactors)
+    {
+      factor->DisconnectPipeline();
+    }
+  }
+
+  const bool releaseData = this->GetReleaseDataFlag();
+  m_FFTFilter->SetReleaseDataFlag(releaseData);
+  m_IFFTFilter->SetReleaseDataFlag(releaseData);
 
-  ArrayType wv;
-  ArrayType orientation;
+  this->BuildPlan(inputSize);
+}
 
-  FloatImageStack tempStack;
-  FloatImageStack lgStack;
-  FloatImageStack sfStack;
 
-  // Create log gabor kernels
-  for (unsigned int w = 0; w < m_Wavelengths.rows(); w++)
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::BuildPlan(const InputImageSizeType & size)
+{
+  // The plan shares the images of the bank, which a later Initialize()
+  // replaces rather than modifies
+  typename PlanType::Pointer plan = PlanType::New();
+  plan->m_Size = size;
+  plan->m_NumberOfPixels = 1;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
   {
-    for (unsigned int i = 0; i < ndims; ++i)
+    plan->m_NumberOfPixels *= size[i];
+  }
+  plan->SetDecimationFactor(m_DecimationFactor);
+  plan->m_NumberOfScales = m_Wavelengths.rows();
+  plan->m_OrientationMultiplicities = m_OrientationMultiplicities;
+  plan->m_Polarity = m_Polarity;
+  plan->m_NoiseThreshold = m_NoiseThreshold;
+
+  for (const auto & entryStack : m_FilterBank)
+  {
+    for (const auto & entry : entryStack)
     {
-      wv[i] = m_Wavelengths.get(w, i);
+      plan->m_FilterBank.push_back(entry.GetPointer());
     }
-    LogGaborKernel->SetWavelengths(wv);
-    LogGaborKernel->SetSigma(m_Sigma);
-    m_MultiplyImageFilter->SetInput1(LogGaborKernel->GetOutput());
-    m_MultiplyImageFilter->SetInput2(ButterworthFilterKernel->GetOutput());
-    m_MultiplyImageFilter->Update();
-    lgStack.push_back(m_MultiplyImageFilter->GetOutput());
-    lgStack[w]->DisconnectPipeline();
   }
-
-  // Create directionality kernels
-  for (unsigned int o = 0; o < m_Orientations.rows(); o++)
+  for (const auto & halfStack : m_HalfFilterBank)
   {
-    for (unsigned int d = 0; d < ndims; ++d)
+    for (const auto & halfEntry : halfStack)
     {
-      orientation[d] = m_Orientations.get(o, d);
+      plan->m_HalfFilterBank.push_back(halfEntry.GetPointer());
     }
-    SteerableFilterKernel->SetOrientation(orientation);
-    SteerableFilterKernel->SetAngularBandwidth(m_AngleBandwidth);
-    SteerableFilterKernel->Update();
-    sfStack.push_back(SteerableFilterKernel->GetOutput());
-    sfStack[o]->DisconnectPipeline();
+  }
+  for (const auto & factor : m_ScaleFactors)
+  {
+    plan->m_ScaleFactors.push_back(factor.GetPointer());
+  }
+  for (const auto & factor : m_OrientationFactors)
+  {
+    plan->m_OrientationFactors.push_back(factor.GetPointer());
+  }
+
+  m_Plan = plan.GetPointer();
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::InitializeSlices()
+{
+  const InputImageType * input = this->GetInput();
+  if (InputImageDimension < 3)
+  {
+    itkExceptionMacro(<< "Slice-wise mode needs an input of at least 3 dimensions");
+  }
+  if (m_DecimationFactor > 1 || m_NumberOfShards > 1)
+  {
+    itkExceptionMacro(<< "Slice-wise mode supports neither decimation nor shards");
   }
 
-  // Create filter bank by multiplying log gabor filters with directional filters
-  typename DoubleFFTShiftImageFilterType::Pointer fftShiftFilter = DoubleFFTShiftImageFilterType::New();
+  // The slices keep the geometry of the other axes; only their size matters
+  // to the bank, which is built in index space
+  const InputImageRegionType                region = input->GetLargestPossibleRegion();
+  typename SliceInputImageType::RegionType  sliceRegion;
+  typename SliceInputImageType::SpacingType sliceSpacing;
+  typename SliceInputImageType::PointType   sliceOrigin;
+  MatrixType                                sliceWavelengths(m_Wavelengths.rows(), SliceDimension);
+  std::vector<unsigned int>                 axes;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+  {
+    if (i != m_SliceAxis)
+    {
+      axes.push_back(i);
+    }
+  }
+  for (unsigned int i = 0; i < SliceDimension; ++i)
+  {
+    sliceRegion.SetIndex(i, region.GetIndex(axes[i]));
+    sliceRegion.SetSize(i, region.GetSize(axes[i]));
+    sliceSpacing[i] = input->GetSpacing()[axes[i]];
+    sliceOrigin[i] = input->GetOrigin()[axes[i]];
+    for (unsigned int w = 0; w < m_Wavelengths.rows(); ++w)
+    {
+      sliceWavelengths(w, i) = m_Wavelengths(w, axes[i]);
+    }
+  }
 
-  for (unsigned int w = 0; w < m_Wavelengths.rows(); w++)
+  // Orientations along the slice axis have no component in the slices
+  std::vector<vnl_vector<double>> inPlaneOrientations;
+  for (unsigned int o = 0; o < m_Orientations.rows(); ++o)
   {
-    tempStack.clear();
-    for (unsigned int o = 0; o < m_Orientations.rows(); o++)
+    vnl_vector<double> orientation(SliceDimension);
+    for (unsigned int i = 0; i < SliceDimension; ++i)
     {
-      m_MultiplyImageFilter->SetInput1(lgStack[w]);
-      m_MultiplyImageFilter->SetInput2(sfStack[o]);
-      fftShiftFilter->SetInput(m_MultiplyImageFilter->GetOutput());
-      fftShiftFilter->Update();
-      tempStack.push_back(fftShiftFilter->GetOutput());
-      tempStack[o]->DisconnectPipeline();
-      typename FloatImageType::RegionType region = tempStack[o]->GetBufferedRegion();
-      region.SetIndex(inputIndex);
-      tempStack[o]->SetRegions(region);
+      orientation[i] = m_Orientations(o, axes[i]);
     }
-    m_FilterBank.push_back(tempStack);
+    if (orientation.two_norm() > 0.0)
+    {
+      inPlaneOrientations.push_back(orientation);
+    }
+  }
+  if (inPlaneOrientations.empty())
+  {
+    itkExceptionMacro(<< "No orientation has a component orthogonal to slice axis " << m_SliceAxis);
+  }
+  MatrixType sliceOrientations(inPlaneOrientations.size(), SliceDimension);
+  for (unsigned int o = 0; o < inPlaneOrientations.size(); ++o)
+  {
+    sliceOrientations.set_row(o, inPlaneOrientations[o]);
   }
 
-  const bool releaseData = this->GetReleaseDataFlag();
-  m_ShiftScaleFilter->SetReleaseDataFlag(releaseData);
-  m_C2MFilter->SetReleaseDataFlag(releaseData);
-  m_C2AFilter->SetReleaseDataFlag(releaseData);
-  m_MultiplyImageFilter->SetReleaseDataFlag(releaseData);
-  m_DivideImageFilter->SetReleaseDataFlag(releaseData);
-  m_MP2CFilter->SetReleaseDataFlag(releaseData);
-  m_FFTFilter->SetReleaseDataFlag(releaseData);
-  m_IFFTFilter->SetReleaseDataFlag(releaseData);
-  m_C2RFilter->SetReleaseDataFlag(releaseData);
-  m_C2IFilter->SetReleaseDataFlag(releaseData);
-  m_MaxImageFilter->SetReleaseDataFlag(releaseData);
-  m_NegateFilter->SetReleaseDataFlag(releaseData);
-  m_NegateFilter2->SetReleaseDataFlag(releaseData);
-  m_AbsImageFilter->SetReleaseDataFlag(releaseData);
-  m_AbsImageFilter2->SetReleaseDataFlag(releaseData);
-  m_MaxImageFilter->SetReleaseDataFlag(releaseData);
-  m_AcosImageFilter->SetReleaseDataFlag(releaseData);
+  // The slice filter only needs the geometry of its input
+  typename SliceInputImageType::Pointer sliceImage = SliceInputImageType::New();
+  sliceImage->SetRegions(sliceRegion);
+  sliceImage->SetSpacing(sliceSpacing);
+  sliceImage->SetOrigin(sliceOrigin);
+
+  m_SliceFilter = SliceFilterType::New();
+  m_SliceFilter->SetInput(sliceImage);
+  m_SliceFilter->SetWavelengths(sliceWavelengths);
+  m_SliceFilter->SetOrientations(sliceOrientations);
+  m_SliceFilter->SetAngleBandwidth(m_AngleBandwidth);
+  m_SliceFilter->SetSigma(m_Sigma);
+  m_SliceFilter->SetNoiseThreshold(m_NoiseThreshold);
+  m_SliceFilter->SetPolarity(m_Polarity);
+  m_SliceFilter->SetAngularTolerance(m_AngularTolerance);
+  m_SliceFilter->SetCanonicalizeOrientations(m_CanonicalizeOrientations);
+  m_SliceFilter->SetPrecomputeFilterBank(m_PrecomputeFilterBank);
+  m_SliceFilter->SetHalfPrecisionFilterBank(m_HalfPrecisionFilterBank);
+  m_SliceFilter->SetMemoryBudget(m_MemoryBudget);
+  m_SliceFilter->SetFFTBackend(FFTBackendEnum::VNL);
+  m_SliceFilter->Initialize();
+
+  if (!m_SliceFilter->GetPlan()->IsSizeSupported())
+  {
+    itkExceptionMacro(<< "Slices of size " << sliceRegion.GetSize()
+                      << " are not supported; their size must have prime factors 2, 3 and 5 only");
+  }
 }
 
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
 void
-PhaseSymmetryImageFilter<TInputImage, TOutputImage>::GenerateData()
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GenerateData()
 {
-  typename TInputImage::SizeType          inputSize;
-  typename TInputImage::IndexType         inputIndex;
-  typename Superclass::OutputImagePointer output = this->GetOutput();
-  typename Superclass::InputImagePointer  input = const_cast<TInputImage *>(this->GetInput());
+  OutputImageType *      output = this->GetOutput();
+  const InputImageType * input = this->GetInput();
 
-  inputIndex = input->GetLargestPossibleRegion().GetIndex();
-  inputSize = input->GetLargestPossibleRegion().GetSize();
-  constexpr unsigned int ndims = TInputImage::ImageDimension;
+  if (m_SliceWise)
+  {
+    this->GenerateSlices();
+    if (m_ProgressiveUpdates != ProgressiveUpdatesEnum::Off)
+    {
+      m_PartialResult = output;
+      this->InvokeEvent(PhaseSymmetryPartialResultEvent(true));
+    }
+    m_PartialResult = nullptr;
+    return;
+  }
+  if (!m_Plan)
+  {
+    itkExceptionMacro(<< "Initialize() must be called before the filter is updated");
+  }
+  // The band-pass, inverse FFTs and accumulation run at the output size,
+  // which is smaller than the input size when decimated
+  const PlanType *    plan = m_Plan;
+  const SizeValueType count = plan->GetNumberOfOutputPixels();
+
+  // A sharded job shares the input spectrum and the accumulators of its
+  // shards through shared memory
+  const bool sharded = m_NumberOfShards > 1;
+  const bool checkpoint = !m_CheckpointFileName.empty();
+  if (sharded)
+  {
+    if (m_ShardIndex >= m_NumberOfShards)
+    {
+      itkExceptionMacro(<< "Shard index " << m_ShardIndex << " must be less than the number of shards "
+                        << m_NumberOfShards);
+    }
+    if (m_SharedMemoryName.empty())
+    {
+      itkExceptionMacro(<< "A sharded job requires a shared memory name");
+    }
+    if (m_ShardRunIdentifier == 0)
+    {
+      itkExceptionMacro(<< "A sharded job requires a nonzero run identifier");
+    }
+    if (checkpoint)
+    {
+      itkExceptionMacro(<< "Checkpoints are not supported with several shards");
+    }
+  }
+  // The fingerprint identifies the job of the shards, or the run of the
+  // checkpoints, and is computed once per update for either
+  const uint64_t fingerprint = (sharded || checkpoint) ? this->ComputeCheckpointFingerprint(input) : 0;
+
+  // The segment holds the spectrum, and the amplitude and energy
+  const SizeValueType                        spectrumBytes = plan->GetNumberOfPixels() * sizeof(ComplexPixelType);
+  const SizeValueType                        sharedBytes = spectrumBytes + 2 * count * sizeof(ComputePixelType);
+  std::unique_ptr<PhaseSymmetrySharedMemory> shared;
+  if (sharded)
+  {
+    shared.reset(new PhaseSymmetrySharedMemory(m_SharedMemoryName, m_ShardTimeout));
+    if (m_ShardIndex == 0)
+    {
+      shared->Create(sharedBytes, fingerprint, m_ShardRunIdentifier, m_NumberOfShards);
+    }
+    else
+    {
+      shared->Open(sharedBytes, fingerprint, m_ShardRunIdentifier, m_NumberOfShards);
+    }
+  }
 
-  typename ComplexImageType::Pointer finput = ComplexImageType::New();
-  typename ComplexImageType::Pointer bpinput = ComplexImageType::New();
+  // The plan carries out the VNL transforms itself, without the pipeline;
+  // other backends run through their FFT filters
+  const bool planTransforms =
+    dynamic_cast<VnlForwardFFTImageFilter<FloatImageType, ComplexImageType> *>(m_FFTFilter.GetPointer()) != nullptr;
+  std::unique_ptr<typename PlanType::FFTTransformType> transform;
+  if (planTransforms)
+  {
+    if (!plan->IsSizeSupported())
+    {
+      itkExceptionMacro(<< "Input size " << plan->GetSize() << " and output size " << plan->GetOutputSize()
+                        << " must have prime factors 2, 3 and 5 only");
+    }
+    transform.reset(new typename PlanType::FFTTransformType(plan->GetOutputSize()));
+  }
+
+  typename ComplexImageType::Pointer spectrum;
+  const ComplexPixelType *           spectrumBuffer = nullptr;
+  if (sharded && m_ShardIndex > 0)
+  {
+    // Shard 0 transforms the input for all the shards
+    shared->WaitFor(shared->GetHeader()->SpectrumReady, 1, "the input spectrum");
+    spectrumBuffer = shared->GetData<ComplexPixelType>(0);
+  }
+  else
+  {
+    if (planTransforms)
+    {
+      typename PlanType::FFTTransformType forwardTransform(plan->GetSize());
+      spectrum = ComplexImageType::New();
+      spectrum->CopyInformation(input);
+      spectrum->SetRegions(input->GetLargestPossibleRegion());
+      spectrum->Allocate();
+      plan->ForwardTransform(input->GetBufferPointer(), spectrum->GetBufferPointer(), forwardTransform);
+    }
+    else if (this->ConvertsInputInFFTWSpectrum(FFTWConvertsInputType()))
+    {
+      spectrum = this->ComputeFFTWSpectrum(input, FFTWConvertsInputType());
+    }
+    else
+    {
+      // A converted input is released as soon as the transform has read it
+      m_FFTFilter->SetInput(this->GetFFTInput(input, std::is_same<InputImageType, FloatImageType>()));
+      m_FFTFilter->Update();
+      spectrum = m_FFTFilter->GetOutput();
+      spectrum->DisconnectPipeline();
+      m_FFTFilter->SetInput(nullptr);
+    }
+    spectrumBuffer = spectrum->GetBufferPointer();
 
+    if (sharded)
+    {
+      ComplexPixelType * sharedSpectrum = shared->GetData<ComplexPixelType>(0);
+      std::copy(spectrumBuffer, spectrumBuffer + plan->GetNumberOfPixels(), sharedSpectrum);
+      shared->GetHeader()->SpectrumReady.store(1, std::memory_order_release);
+      spectrum = nullptr;
+      spectrumBuffer = sharedSpectrum;
+    }
+  }
 
-  m_FFTFilter->SetInput(input);
-  m_FFTFilter->Update();
-  finput = m_FFTFilter->GetOutput();
-  finput->DisconnectPipeline();
+  // Band-passed spectrum, the input of every inverse FFT
+  typename ComplexImageType::Pointer bandPassSpectrum = ComplexImageType::New();
+  bandPassSpectrum->CopyInformation(output);
+  bandPassSpectrum->SetRegions(output->GetLargestPossibleRegion());
+  bandPassSpectrum->Allocate();
+
+  // The amplitude and energy accumulate over each loop, from zero
+  typename FloatImageType::Pointer totalAmplitude = this->CreateZeroImage();
+  typename FloatImageType::Pointer totalEnergy = this->CreateZeroImage();
+  typename FloatImageType::Pointer orientationEnergy = this->CreateZeroImage();
+
+  // Resume after the orientations of a checkpoint of the same run
+  m_NumberOfResumedOrientations = checkpoint ? this->ReadCheckpoint(fingerprint, totalAmplitude, totalEnergy) : 0;
+
+  ComplexPixelType *       bandPassBuffer = bandPassSpectrum->GetBufferPointer();
+  ComputePixelType *       amplitudeBuffer = totalAmplitude->GetBufferPointer();
+  ComputePixelType *       energyBuffer = totalEnergy->GetBufferPointer();
+  ComputePixelType *       orientationEnergyBuffer = orientationEnergy->GetBufferPointer();
+
+  // Within an orientation, the partial results of its first scales add its
+  // energy so far, less its noise threshold, to a copy of the total energy.
+  // A shard only has a part of the result until the reduction.
+  m_PartialResult = nullptr;
+  const bool progressive = m_ProgressiveUpdates != ProgressiveUpdatesEnum::Off && !sharded;
+  const bool perScale = progressive && m_ProgressiveUpdates == ProgressiveUpdatesEnum::PerScale;
+  typename FloatImageType::Pointer partialEnergy;
+  ComputePixelType *               partialBuffer = nullptr;
+  if (perScale)
+  {
+    partialEnergy = this->CreateZeroImage();
+    partialBuffer = partialEnergy->GetBufferPointer();
+  }
 
+  // A shard computes a contiguous range of the scale x orientation entries,
+  // in the order of the loops below; the whole job is one range
+  const unsigned int  numberOfOrientations = plan->GetNumberOfDistinctOrientations();
+  const unsigned int  numberOfScales = plan->GetNumberOfScales();
+  const SizeValueType numberOfEntries = SizeValueType(numberOfOrientations) * numberOfScales;
+  const SizeValueType firstEntry = numberOfEntries * m_ShardIndex / m_NumberOfShards;
+  const SizeValueType lastEntry = numberOfEntries * (m_ShardIndex + 1) / m_NumberOfShards;
 
-  // Get the pixel count.  We need to divide the IFFT output by this because using the inverse FFT for
-  // complex to complex doesn't seem to work.   So instead, we use the forward transform and divide by pixelNum
-  double pxlCount = 1.0;
-  for (unsigned int i = 0; i < ndims; ++i)
+  for (unsigned int o = m_NumberOfResumedOrientations; o < numberOfOrientations; ++o)
   {
-    pxlCount = pxlCount * double(inputSize[i]);
+    const SizeValueType orientationEntry = SizeValueType(o) * numberOfScales;
+    if (orientationEntry + numberOfScales <= firstEntry || orientationEntry >= lastEntry)
+    {
+      continue;
+    }
+
+    // The range that holds the first scale of the orientation subtracts its
+    // noise threshold; other ranges add their scales to the energy directly
+    const bool         subtractThreshold = orientationEntry >= firstEntry;
+    ComputePixelType * scaleEnergyBuffer = subtractThreshold ? orientationEnergyBuffer : energyBuffer;
+    orientationEnergy->FillBuffer(NumericTraits<ComputePixelType>::ZeroValue());
+
+    for (unsigned int w = 0; w < numberOfScales; ++w)
+    {
+      if (orientationEntry + w < firstEntry || orientationEntry + w >= lastEntry)
+      {
+        continue;
+      }
+
+      this->ParallelizeBuffer(count,
+                              [plan, w, o, spectrumBuffer, bandPassBuffer](SizeValueType begin, SizeValueType end) {
+                                plan->BandPass(w, o, spectrumBuffer, bandPassBuffer, begin, end);
+                              });
+
+      const ComplexPixelType *           response = bandPassBuffer;
+      typename ComplexImageType::Pointer inverseOutput;
+      if (planTransforms)
+      {
+        transform->transform(bandPassBuffer, -1);
+      }
+      else
+      {
+        bandPassSpectrum->Modified();
+        m_IFFTFilter->SetInput(bandPassSpectrum);
+        m_IFFTFilter->Update();
+        inverseOutput = m_IFFTFilter->GetOutput();
+        response = inverseOutput->GetBufferPointer();
+      }
+
+      this->ParallelizeBuffer(
+        count, [plan, response, amplitudeBuffer, scaleEnergyBuffer](SizeValueType begin, SizeValueType end) {
+          plan->AccumulateResponse(response, amplitudeBuffer, scaleEnergyBuffer, begin, end);
+        });
+
+      if (perScale && w + 1 < numberOfScales)
+      {
+        this->ParallelizeBuffer(
+          count,
+          [plan, o, orientationEnergyBuffer, energyBuffer, partialBuffer](SizeValueType begin, SizeValueType end) {
+            std::copy(energyBuffer + begin, energyBuffer + end, partialBuffer + begin);
+            plan->AccumulateEnergy(o, orientationEnergyBuffer, partialBuffer, begin, end);
+          });
+        this->InvokePartialResult(amplitudeBuffer, partialBuffer);
+      }
+    }
+
+    // Subtract the noise threshold of the orientations that share this
+    // response
+    if (subtractThreshold)
+    {
+      this->ParallelizeBuffer(
+        count, [plan, o, orientationEnergyBuffer, energyBuffer](SizeValueType begin, SizeValueType end) {
+          plan->AccumulateEnergy(o, orientationEnergyBuffer, energyBuffer, begin, end);
+        });
+    }
+
+    const unsigned int completed = o + 1;
+    if (checkpoint && completed < numberOfOrientations &&
+        (completed - m_NumberOfResumedOrientations) % m_CheckpointInterval == 0)
+    {
+      this->WriteCheckpoint(fingerprint, completed, totalAmplitude, totalEnergy);
+    }
+    if (progressive && completed < numberOfOrientations)
+    {
+      this->InvokePartialResult(amplitudeBuffer, energyBuffer);
+    }
+    this->InvokeEvent(IterationEvent());
   }
 
+  if (checkpoint)
+  {
+    std::remove(m_CheckpointFileName.c_str());
+  }
 
-  typename FloatImageType::Pointer EnergyThisOrient = FloatImageType::New();
-  typename FloatImageType::Pointer totalAmplitude = FloatImageType::New();
-  typename FloatImageType::Pointer totalEnergy = FloatImageType::New();
+  if (sharded)
+  {
+    this->ReduceShards(*shared, spectrumBytes, amplitudeBuffer, energyBuffer, count);
+  }
 
-  // Matlab style initalization, because these images accumulate over each loop
-  // Therefore, they initially all zeros
-  m_ShiftScaleFilter->SetScale(0.0);
-  m_ShiftScaleFilter->SetShift(0.0);
+  // Set negative values to zero and divide total energy by total amplitude
+  // over all scales and orientations, in one pass that writes the output
+  // pixel type
+  output->SetBufferedRegion(output->GetLargestPossibleRegion());
+  output->Allocate();
 
-  m_ShiftScaleFilter->Update();
-  totalAmplitude = m_ShiftScaleFilter->GetOutput();
-  totalAmplitude->DisconnectPipeline();
+  OutputImagePixelType * outputBuffer = output->GetBufferPointer();
+  this->ParallelizeBuffer(
+    count, [plan, amplitudeBuffer, energyBuffer, outputBuffer](SizeValueType begin, SizeValueType end) {
+      plan->ComputeOutput(amplitudeBuffer, energyBuffer, outputBuffer, begin, end);
+    });
 
-  m_ShiftScaleFilter->Update();
-  totalEnergy = m_ShiftScaleFilter->GetOutput();
-  totalEnergy->DisconnectPipeline();
+  // The final result is the output itself
+  if (m_ProgressiveUpdates != ProgressiveUpdatesEnum::Off)
+  {
+    m_PartialResult = output;
+    this->InvokeEvent(PhaseSymmetryPartialResultEvent(true));
+  }
+  m_PartialResult = nullptr;
+}
 
-  for (unsigned int o = 0; o < m_Orientations.rows(); ++o)
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GenerateSlices()
+{
+  OutputImageType *      output = this->GetOutput();
+  const InputImageType * input = this->GetInput();
+
+  using SlicePlanType = typename SliceFilterType::PlanType;
+  const SlicePlanType * plan = m_SliceFilter ? m_SliceFilter->GetPlan() : nullptr;
+  if (!plan)
   {
-    // Reset the energy value
-    m_ShiftScaleFilter->SetScale(0.0);
-    m_ShiftScaleFilter->SetShift(0.0);
-    m_ShiftScaleFilter->Update();
-    EnergyThisOrient = m_ShiftScaleFilter->GetOutput();
-    EnergyThisOrient->DisconnectPipeline();
+    itkExceptionMacro(<< "Initialize() must be called in slice-wise mode before the filter is updated");
+  }
 
-    for (unsigned int w = 0; w < m_Wavelengths.rows(); ++w)
+  // Whole slices, over the slices of the requested region only
+  InputImageRegionType region = output->GetLargestPossibleRegion();
+  region.SetIndex(m_SliceAxis, output->GetRequestedRegion().GetIndex(m_SliceAxis));
+  region.SetSize(m_SliceAxis, output->GetRequestedRegion().GetSize(m_SliceAxis));
+  for (unsigned int i = 0, j = 0; i < InputImageDimension; ++i)
+  {
+    if (i != m_SliceAxis && region.GetSize(i) != plan->GetSize()[j++])
+    {
+      itkExceptionMacro(<< "The slice filter was initialized for another slice size; call Initialize() again");
+    }
+  }
+  output->SetBufferedRegion(region);
+  output->Allocate();
+
+  // Offsets of the pixels of a slice, in the order of the plan, in the
+  // buffers of the input and the output, whose strides differ when the input
+  // buffers more slices than the output
+  const SizeValueType          slicePixels = plan->GetNumberOfPixels();
+  const OffsetValueType *      inputStrides = input->GetOffsetTable();
+  const OffsetValueType *      outputStrides = output->GetOffsetTable();
+  std::vector<OffsetValueType> inputOffsets(slicePixels, 0);
+  std::vector<OffsetValueType> outputOffsets(slicePixels, 0);
+  for (SizeValueType p = 0; p < slicePixels; ++p)
+  {
+    SizeValueType remainder = p;
+    for (unsigned int i = 0; i < InputImageDimension; ++i)
     {
-      // Multiply filters by the input image in fourier domain
-      m_C2MFilter->SetInput(finput);
-      m_C2AFilter->SetInput(finput);
-      m_ShiftScaleFilter->SetScale(1 / pxlCount);
-      m_ShiftScaleFilter->SetShift(0.0);
-      // Normalize the magnitude by the number of pixels
-      m_ShiftScaleFilter->SetInput(m_C2MFilter->GetOutput());
+      if (i != m_SliceAxis)
+      {
+        const auto coordinate = static_cast<OffsetValueType>(remainder % region.GetSize(i));
+        remainder /= region.GetSize(i);
+        inputOffsets[p] += coordinate * inputStrides[i];
+        outputOffsets[p] += coordinate * outputStrides[i];
+      }
+    }
+  }
 
-      m_MultiplyImageFilter->SetInput1(m_ShiftScaleFilter->GetOutput());
-      m_MultiplyImageFilter->SetInput2(m_FilterBank[w][o]);
+  // Slices along the last axis are contiguous in both buffers, and run in
+  // place; the others are gathered and scattered through per-chunk buffers
+  const bool                  contiguous = m_SliceAxis == InputImageDimension - 1;
+  const OffsetValueType       inputSliceStride = inputStrides[m_SliceAxis];
+  const OffsetValueType       outputSliceStride = outputStrides[m_SliceAxis];
+  const InputImagePixelType * inputBuffer = input->GetBufferPointer() + input->ComputeOffset(region.GetIndex());
+  OutputImagePixelType *      outputBuffer = output->GetBufferPointer() + output->ComputeOffset(region.GetIndex());
+  this->ParallelizeBuffer(
+    region.GetSize(m_SliceAxis),
+    [plan, inputBuffer, outputBuffer, inputSliceStride, outputSliceStride, &inputOffsets, &outputOffsets, slicePixels,
+     contiguous](SizeValueType begin, SizeValueType end) {
+      typename SlicePlanType::ScratchType scratch;
+      std::vector<InputImagePixelType>    sliceInput(contiguous ? 0 : slicePixels);
+      std::vector<OutputImagePixelType>   sliceOutput(contiguous ? 0 : slicePixels);
+      for (SizeValueType s = begin; s < end; ++s)
+      {
+        const InputImagePixelType * in = inputBuffer + static_cast<OffsetValueType>(s) * inputSliceStride;
+        OutputImagePixelType *      out = outputBuffer + static_cast<OffsetValueType>(s) * outputSliceStride;
+        if (contiguous)
+        {
+          plan->Execute(in, out, scratch);
+          continue;
+        }
+        for (SizeValueType p = 0; p < slicePixels; ++p)
+        {
+          sliceInput[p] = in[inputOffsets[p]];
+        }
+        plan->Execute(sliceInput.data(), sliceOutput.data(), scratch);
+        for (SizeValueType p = 0; p < slicePixels; ++p)
+        {
+          out[outputOffsets[p]] = sliceOutput[p];
+        }
+      }
+    });
+}
 
-      m_MultiplyImageFilter->Update();
 
-      m_MP2CFilter->SetInput1(m_MultiplyImageFilter->GetOutput());
-      m_MP2CFilter->SetInput2(m_C2AFilter->GetOutput());
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ReduceShards(
+  PhaseSymmetrySharedMemory & shared,
+  SizeValueType               accumulatorOffset,
+  ComputePixelType *          amplitude,
+  ComputePixelType *          energy,
+  SizeValueType               count)
+{
+  PhaseSymmetrySharedMemory::HeaderType * header = shared.GetHeader();
+
+  // The amplitude and then the energy follow the spectrum
+  const SizeValueType accumulatorBytes = count * sizeof(ComputePixelType);
+  ComputePixelType *  sharedAmplitude = shared.GetData<ComputePixelType>(accumulatorOffset);
+  ComputePixelType *  sharedEnergy = shared.GetData<ComputePixelType>(accumulatorOffset + accumulatorBytes);
+
+  // The shards add their accumulators one at a time, in the order in which
+  // they finish; the first one replaces the initial contents
+  const unsigned int ticket = header->NextTicket.fetch_add(1);
+  shared.WaitFor(header->NumberOfReducedProcesses, ticket, "the shards that finished earlier");
+  this->ParallelizeBuffer(
+    count, [ticket, amplitude, energy, sharedAmplitude, sharedEnergy](SizeValueType begin, SizeValueType end) {
+      for (SizeValueType i = begin; i < end; ++i)
+      {
+        sharedAmplitude[i] = ticket == 0 ? amplitude[i] : sharedAmplitude[i] + amplitude[i];
+        sharedEnergy[i] = ticket == 0 ? energy[i] : sharedEnergy[i] + energy[i];
+      }
+    });
+  header->NumberOfReducedProcesses.store(ticket + 1, std::memory_order_release);
+
+  // Every shard computes the whole output from the sum
+  shared.WaitFor(header->NumberOfReducedProcesses, m_NumberOfShards, "the other shards");
+  this->ParallelizeBuffer(
+    count, [amplitude, energy, sharedAmplitude, sharedEnergy](SizeValueType begin, SizeValueType end) {
+      std::copy(sharedAmplitude + begin, sharedAmplitude + end, amplitude + begin);
+      std::copy(sharedEnergy + begin, sharedEnergy + end, energy + begin);
+    });
+}
 
-      m_IFFTFilter->SetInput(m_MP2CFilter->GetOutput());
-      m_IFFTFilter->Update();
-      bpinput = m_IFFTFilter->GetOutput();
-      bpinput->DisconnectPipeline();
 
-      // Get mag, real and imag of the band passed images
-      m_C2MFilter->SetInput(bpinput);
-      m_C2RFilter->SetInput(bpinput);
-      m_C2IFilter->SetInput(bpinput);
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::InvokePartialResult(
+  const ComputePixelType * amplitude,
+  const ComputePixelType * energy)
+{
+  if (!m_PartialResult)
+  {
+    const OutputImageType * output = this->GetOutput();
+    m_PartialResult = OutputImageType::New();
+    m_PartialResult->CopyInformation(output);
+    m_PartialResult->SetRegions(output->GetLargestPossibleRegion());
+    m_PartialResult->Allocate();
+  }
+
+  const PlanType *       plan = m_Plan;
+  OutputImagePixelType * partialBuffer = m_PartialResult->GetBufferPointer();
+  this->ParallelizeBuffer(plan->GetNumberOfOutputPixels(),
+                          [plan, amplitude, energy, partialBuffer](SizeValueType begin, SizeValueType end) {
+                            plan->ComputeOutput(amplitude, energy, partialBuffer, begin, end);
+                          });
+  this->InvokeEvent(PhaseSymmetryPartialResultEvent(false));
+}
+
 
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::FloatImageType::ConstPointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GetFFTInput(const InputImageType * input,
+                                                                                std::true_type)
+{
+  return input;
+}
 
-      m_AddImageFilter->SetInput1(m_C2MFilter->GetOutput());
-      m_AddImageFilter->SetInput2(totalAmplitude);
-      m_AddImageFilter->Update();
-      totalAmplitude = m_AddImageFilter->GetOutput();
-      totalAmplitude->DisconnectPipeline();
 
-      // Use appropraite equation depending on polarity
-      if (m_Polarity == 0)
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::FloatImageType::ConstPointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GetFFTInput(const InputImageType * input,
+                                                                                std::false_type)
+{
+  const InputImageRegionType region = input->GetLargestPossibleRegion();
+
+  typename FloatImageType::Pointer fftInput = FloatImageType::New();
+  fftInput->CopyInformation(input);
+  fftInput->SetRegions(region);
+  fftInput->Allocate();
+
+  FloatImageType * fftInputPointer = fftInput;
+  this->GetMultiThreader()->template ParallelizeImageRegion<InputImageDimension>(
+    region,
+    [input, fftInputPointer](const InputImageRegionType & inputRegion) {
+      ImageRegionConstIterator<InputImageType> inputIt(input, inputRegion);
+      ImageRegionIterator<FloatImageType>      fftInputIt(fftInputPointer, inputRegion);
+      for (; !inputIt.IsAtEnd(); ++inputIt, ++fftInputIt)
       {
-        m_AbsImageFilter->SetInput(m_C2RFilter->GetOutput());
-        m_AbsImageFilter2->SetInput(m_C2IFilter->GetOutput());
+        fftInputIt.Set(static_cast<ComputePixelType>(inputIt.Get()));
+      }
+    },
+    nullptr);
 
-        m_NegateFilter->SetInput(m_AbsImageFilter2->GetOutput());
+  return fftInput.GetPointer();
+}
 
-        m_AddImageFilter->SetInput1(m_AbsImageFilter->GetOutput());
-        m_AddImageFilter->SetInput2(m_NegateFilter->GetOutput());
 
-        m_AddImageFilter2->SetInput1(m_AddImageFilter->GetOutput());
-        m_AddImageFilter2->SetInput2(EnergyThisOrient);
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+bool
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ConvertsInputInFFTWSpectrum(std::true_type) const
+{
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+  using FFTWForwardFilterType = FFTWForwardFFTImageFilter<FloatImageType, ComplexImageType>;
+  return dynamic_cast<const FFTWForwardFilterType *>(m_FFTFilter.GetPointer()) != nullptr;
+#else
+  return false;
+#endif
+}
 
-        m_AddImageFilter2->Update();
-        EnergyThisOrient = m_AddImageFilter2->GetOutput();
-        EnergyThisOrient->DisconnectPipeline();
-      }
-      else if (m_Polarity == 1)
-      {
-        m_AbsImageFilter->SetInput(m_C2IFilter->GetOutput());
-        m_NegateFilter->SetInput(m_AbsImageFilter->GetOutput());
 
-        m_AddImageFilter->SetInput1(m_C2RFilter->GetOutput());
-        m_AddImageFilter->SetInput2(m_NegateFilter->GetOutput());
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ComplexImageType::Pointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ComputeFFTWSpectrum(const InputImageType * input,
+                                                                                        std::true_type)
+{
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+  using FFTWForwardFilterType = FFTWForwardFFTImageFilter<FloatImageType, ComplexImageType>;
+  using ProxyType = fftw::Proxy<ComplexPixelComponentType>;
+  const auto * forwardFilter = static_cast<const FFTWForwardFilterType *>(m_FFTFilter.GetPointer());
+
+  const InputImageRegionType region = input->GetLargestPossibleRegion();
+  const InputImageSizeType   size = region.GetSize();
+  const SizeValueType        lineLength = size[0];
+  const SizeValueType        halfLineLength = lineLength / 2 + 1;
+  const SizeValueType        numberOfLines = region.GetNumberOfPixels() / lineLength;
+
+  typename ComplexImageType::Pointer spectrum = ComplexImageType::New();
+  spectrum->CopyInformation(input);
+  spectrum->SetRegions(region);
+  spectrum->Allocate();
+  ComplexPixelType * spectrumBuffer = spectrum->GetBufferPointer();
+  auto *             realBuffer = reinterpret_cast<ComputePixelType *>(spectrumBuffer);
+
+  // FFTW orders the axes from the slowest. Planning may overwrite the
+  // buffer, so it comes before the input is converted into it.
+  int sizes[InputImageDimension];
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+  {
+    sizes[InputImageDimension - 1 - i] = static_cast<int>(size[i]);
+  }
+  typename ProxyType::PlanType plan =
+    ProxyType::Plan_dft_r2c(static_cast<int>(InputImageDimension),
+                            sizes,
+                            realBuffer,
+                            reinterpret_cast<typename ProxyType::ComplexType *>(spectrumBuffer),
+                            static_cast<unsigned int>(forwardFilter->GetPlanRigor()),
+                            static_cast<int>(this->GetNumberOfWorkUnits()),
+                            true);
+
+  // Each line of n pixels takes 2 (n / 2 + 1) reals, which the line of its
+  // n / 2 + 1 frequencies replaces
+  const InputImagePixelType * inputBuffer = input->GetBufferPointer();
+  this->ParallelizeBuffer(numberOfLines,
+                          [inputBuffer, realBuffer, lineLength, halfLineLength](SizeValueType begin,
+                                                                                SizeValueType end) {
+                            for (SizeValueType line = begin; line < end; ++line)
+                            {
+                              const InputImagePixelType * inputLine = inputBuffer + line * lineLength;
+                              ComputePixelType *          realLine = realBuffer + line * 2 * halfLineLength;
+                              for (SizeValueType x = 0; x < lineLength; ++x)
+                              {
+                                realLine[x] = static_cast<ComputePixelType>(inputLine[x]);
+                              }
+                            }
+                          });
+  ProxyType::Execute(plan);
+  ProxyType::DestroyPlan(plan);
+
+  // Move the lines of the half spectrum to their place in the full
+  // spectrum, from the last line, which moves farthest
+  for (SizeValueType line = numberOfLines - 1; line > 0; --line)
+  {
+    std::copy_backward(spectrumBuffer + line * halfLineLength,
+                       spectrumBuffer + (line + 1) * halfLineLength,
+                       spectrumBuffer + line * lineLength + halfLineLength);
+  }
+
+  // The missing frequency k of a line is the conjugate of the frequency
+  // n - k of the line at the opposite frequencies along the other axes
+  this->ParallelizeBuffer(numberOfLines,
+                          [spectrumBuffer, size, lineLength, halfLineLength](SizeValueType begin, SizeValueType end) {
+                            for (SizeValueType line = begin; line < end; ++line)
+                            {
+                              SizeValueType remainder = line;
+                              SizeValueType opposite = 0;
+                              SizeValueType stride = 1;
+                              for (unsigned int i = 1; i < InputImageDimension; ++i)
+                              {
+                                const SizeValueType index = remainder % size[i];
+                                remainder /= size[i];
+                                opposite += ((size[i] - index) % size[i]) * stride;
+                                stride *= size[i];
+                              }
+                              ComplexPixelType *       spectrumLine = spectrumBuffer + line * lineLength;
+                              const ComplexPixelType * oppositeLine = spectrumBuffer + opposite * lineLength;
+                              for (SizeValueType k = halfLineLength; k < lineLength; ++k)
+                              {
+                                spectrumLine[k] = std::conj(oppositeLine[lineLength - k]);
+                              }
+                            }
+                          });
+  return spectrum;
+#else
+  (void)input;
+  return nullptr;
+#endif
+}
 
-        m_AddImageFilter2->SetInput1(m_AddImageFilter->GetOutput());
-        m_AddImageFilter2->SetInput2(EnergyThisOrient);
 
-        m_AddImageFilter2->Update();
-        EnergyThisOrient = m_AddImageFilter2->GetOutput();
-        EnergyThisOrient->DisconnectPipeline();
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::HalfImageType::Pointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ConvertToHalfPrecision(
+  const FloatImageType * entry)
+{
+  typename HalfImageType::Pointer halfEntry = HalfImageType::New();
+  halfEntry->CopyInformation(entry);
+  halfEntry->SetRegions(entry->GetBufferedRegion());
+  halfEntry->Allocate();
+
+  const ComputePixelType * entryBuffer = entry->GetBufferPointer();
+  HalfPixelType *          halfBuffer = halfEntry->GetBufferPointer();
+  this->ParallelizeBuffer(entry->GetBufferedRegion().GetNumberOfPixels(),
+                          [entryBuffer, halfBuffer](SizeValueType begin, SizeValueType end) {
+                            for (SizeValueType i = begin; i < end; ++i)
+                            {
+                              halfBuffer[i] = PhaseSymmetryHalfFloat::FromFloat(static_cast<float>(entryBuffer[i]));
+                            }
+                          });
+  return halfEntry;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+template <typename TFunction>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ParallelizeBuffer(SizeValueType count,
+                                                                                       TFunction     function)
+{
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  const SizeValueType chunks =
+    std::max<SizeValueType>(1, std::min<SizeValueType>(count, multiThreader->GetNumberOfWorkUnits()));
+  multiThreader->ParallelizeArray(
+    0,
+    chunks,
+    [count, chunks, &function](SizeValueType chunk) { function(count * chunk / chunks, count * (chunk + 1) / chunks); },
+    nullptr);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::FloatImageType::Pointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CreateZeroImage() const
+{
+  const OutputImageType * output = this->GetOutput();
+
+  typename FloatImageType::Pointer image = FloatImageType::New();
+  image->CopyInformation(output);
+  image->SetRegions(output->GetLargestPossibleRegion());
+  image->Allocate();
+  image->FillBuffer(NumericTraits<ComputePixelType>::ZeroValue());
+  return image;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+uint64_t
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::HashBytes(uint64_t      hash,
+                                                                              const void *  data,
+                                                                              SizeValueType count)
+{
+  const auto * bytes = static_cast<const unsigned char *>(data);
+  for (SizeValueType i = 0; i < count; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+uint64_t
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::HashWords(uint64_t      hash,
+                                                                              const void *  data,
+                                                                              SizeValueType count)
+{
+  // Each word is mixed in one multiplication, and its high bits are folded
+  // back so that they reach the low bits of the next multiplication
+  const auto *        bytes = static_cast<const unsigned char *>(data);
+  const SizeValueType numberOfWords = count / sizeof(uint64_t);
+  for (SizeValueType i = 0; i < numberOfWords; ++i)
+  {
+    uint64_t word;
+    std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+    hash ^= word;
+    hash *= 1099511628211ull;
+    hash ^= hash >> 32;
+  }
+  return HashBytes(hash, bytes + numberOfWords * sizeof(uint64_t), count % sizeof(uint64_t));
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+uint64_t
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ComputeCheckpointFingerprint(
+  const InputImageType * input) const
+{
+  uint64_t hash = 14695981039346656037ull;
+
+  const uint64_t layout[] = { sizeof(InputImagePixelType),
+                              sizeof(ComputePixelType),
+                              m_Wavelengths.rows(),
+                              m_Wavelengths.cols(),
+                              m_Orientations.rows(),
+                              m_Orientations.cols() };
+  hash = HashBytes(hash, layout, sizeof(layout));
+  const typename InputImageType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+  for (unsigned int dim = 0; dim < InputImageDimension; ++dim)
+  {
+    const uint64_t extent = size[dim];
+    hash = HashBytes(hash, &extent, sizeof(extent));
+  }
+
+  // The bank source is given the geometry of the input, so that a resampled
+  // input of the same size does not resume the checkpoint of another
+  for (unsigned int dim = 0; dim < InputImageDimension; ++dim)
+  {
+    const double geometry[] = { input->GetSpacing()[dim], input->GetOrigin()[dim] };
+    hash = HashBytes(hash, geometry, sizeof(geometry));
+    for (unsigned int col = 0; col < InputImageDimension; ++col)
+    {
+      const double direction = input->GetDirection()[dim][col];
+      hash = HashBytes(hash, &direction, sizeof(direction));
+    }
+  }
+
+  const double parameters[] = { m_AngleBandwidth,
+                                m_Sigma,
+                                m_NoiseThreshold,
+                                static_cast<double>(m_Polarity),
+                                double(m_HalfPrecisionFilterBank),
+                                double(m_CanonicalizeOrientations),
+                                double(m_DecimationFactor) };
+  hash = HashBytes(hash, parameters, sizeof(parameters));
+  hash = HashBytes(hash, &m_AngularTolerance, sizeof(m_AngularTolerance));
+  hash = HashBytes(hash, m_Wavelengths.data_block(), m_Wavelengths.size() * sizeof(double));
+  hash = HashBytes(hash, m_Orientations.data_block(), m_Orientations.size() * sizeof(double));
+
+  return HashWords(hash,
+                   input->GetBufferPointer(),
+                   input->GetBufferedRegion().GetNumberOfPixels() * sizeof(InputImagePixelType));
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+unsigned int
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ReadCheckpoint(uint64_t         fingerprint,
+                                                                                   FloatImageType * amplitude,
+                                                                                   FloatImageType * energy) const
+{
+  std::ifstream file(m_CheckpointFileName.c_str(), std::ios::binary);
+  if (!file)
+  {
+    return 0;
+  }
+
+  // Header: magic, fingerprint, completed orientations, pixel count
+  char                magic[8];
+  uint64_t            storedFingerprint = 0;
+  uint32_t            completed = 0;
+  uint64_t            storedCount = 0;
+  const SizeValueType count = amplitude->GetBufferedRegion().GetNumberOfPixels();
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&storedFingerprint), sizeof(storedFingerprint));
+  file.read(reinterpret_cast<char *>(&completed), sizeof(completed));
+  file.read(reinterpret_cast<char *>(&storedCount), sizeof(storedCount));
+  if (!file || std::memcmp(magic, "PSYMCKP1", sizeof(magic)) != 0 || storedFingerprint != fingerprint ||
+      storedCount != count || completed == 0 || completed >= m_DistinctOrientations.rows())
+  {
+    itkWarningMacro(<< "Ignoring the checkpoint " << m_CheckpointFileName << ", which belongs to another run");
+    return 0;
+  }
+
+  const auto bytes = static_cast<std::streamsize>(count * sizeof(ComputePixelType));
+  file.read(reinterpret_cast<char *>(amplitude->GetBufferPointer()), bytes);
+  file.read(reinterpret_cast<char *>(energy->GetBufferPointer()), bytes);
+  if (!file)
+  {
+    itkWarningMacro(<< "Ignoring the truncated checkpoint " << m_CheckpointFileName);
+    amplitude->FillBuffer(NumericTraits<ComputePixelType>::ZeroValue());
+    energy->FillBuffer(NumericTraits<ComputePixelType>::ZeroValue());
+    return 0;
+  }
+  return completed;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::WriteCheckpoint(
+  uint64_t               fingerprint,
+  unsigned int           completedOrientations,
+  const FloatImageType * amplitude,
+  const FloatImageType * energy) const
+{
+  // Write a new file and rename it over the previous checkpoint, so that a
+  // run stopped while writing leaves the previous checkpoint intact
+  const std::string temporaryFileName = m_CheckpointFileName + ".tmp";
+  std::ofstream     file(temporaryFileName.c_str(), std::ios::binary | std::ios::trunc);
+
+  const uint32_t      completed = completedOrientations;
+  const SizeValueType count = amplitude->GetBufferedRegion().GetNumberOfPixels();
+  const uint64_t      storedCount = count;
+  const auto          bytes = static_cast<std::streamsize>(count * sizeof(ComputePixelType));
+  file.write("PSYMCKP1", 8);
+  file.write(reinterpret_cast<const char *>(&fingerprint), sizeof(fingerprint));
+  file.write(reinterpret_cast<const char *>(&completed), sizeof(completed));
+  file.write(reinterpret_cast<const char *>(&storedCount), sizeof(storedCount));
+  file.write(reinterpret_cast<const char *>(amplitude->GetBufferPointer()), bytes);
+  file.write(reinterpret_cast<const char *>(energy->GetBufferPointer()), bytes);
+  file.close();
+  if (!file)
+  {
+    itkWarningMacro(<< "Could not write the checkpoint " << temporaryFileName);
+    std::remove(temporaryFileName.c_str());
+    return;
+  }
+
+  if (!Self::ReplaceFile(temporaryFileName, m_CheckpointFileName))
+  {
+    itkWarningMacro(<< "Could not replace the checkpoint " << m_CheckpointFileName);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+bool
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ReplaceFile(const std::string & source,
+                                                                                const std::string & destination)
+{
+  if (std::rename(source.c_str(), destination.c_str()) == 0)
+  {
+    return true;
+  }
+  // Renaming over an existing file fails on some platforms
+  std::remove(destination.c_str());
+  return std::rename(source.c_str(), destination.c_str()) == 0;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CreateFFTFilters(const InputImageSizeType & size)
+{
+  FFTBackendEnum   backend = m_FFTBackend;
+  FFTPlanRigorEnum rigor = m_FFTPlanRigor;
+  if (backend == FFTBackendEnum::Autotune)
+  {
+    this->AutotuneFFT(size, backend, rigor);
+  }
+  this->CreateFFTFilters(backend, rigor);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CreateFFTFilters(FFTBackendEnum   backend,
+                                                                                     FFTPlanRigorEnum rigor)
+{
+  switch (backend)
+  {
+    case FFTBackendEnum::VNL:
+      m_FFTFilter = VnlForwardFFTImageFilter<FloatImageType, ComplexImageType>::New().GetPointer();
+      m_IFFTFilter = VnlComplexToComplexFFTImageFilter<ComplexImageType>::New().GetPointer();
+      break;
+    case FFTBackendEnum::FFTW:
+      this->CreateFFTWFilters(rigor, typename PhaseSymmetryFFTWTraits<ComplexPixelComponentType>::Available());
+      break;
+    default:
+      m_FFTFilter = FFTFilterType::New();
+      m_IFFTFilter = IFFTFilterType::New();
+      break;
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CreateFFTWFilters(FFTPlanRigorEnum rigor,
+                                                                                      std::true_type)
+{
+#if defined(ITK_USE_FFTWF) || defined(ITK_USE_FFTWD)
+  int planRigor = FFTW_ESTIMATE;
+  switch (rigor)
+  {
+    case FFTPlanRigorEnum::Measure:
+      planRigor = FFTW_MEASURE;
+      break;
+    case FFTPlanRigorEnum::Patient:
+      planRigor = FFTW_PATIENT;
+      break;
+    case FFTPlanRigorEnum::Exhaustive:
+      planRigor = FFTW_EXHAUSTIVE;
+      break;
+    default:
+      break;
+  }
+
+  using FFTWForwardFilterType = FFTWForwardFFTImageFilter<FloatImageType, ComplexImageType>;
+  typename FFTWForwardFilterType::Pointer forwardFilter = FFTWForwardFilterType::New();
+  forwardFilter->SetPlanRigor(planRigor);
+  m_FFTFilter = forwardFilter.GetPointer();
+
+  using FFTWInverseFilterType = FFTWComplexToComplexFFTImageFilter<ComplexImageType>;
+  typename FFTWInverseFilterType::Pointer inverseFilter = FFTWInverseFilterType::New();
+  inverseFilter->SetPlanRigor(planRigor);
+  m_IFFTFilter = inverseFilter.GetPointer();
+#else
+  (void)rigor;
+#endif
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CreateFFTWFilters(FFTPlanRigorEnum, std::false_type)
+{
+  itkExceptionMacro(<< "The FFTW backend is not available: ITK was not built with FFTW for pixels of "
+                    << sizeof(ComplexPixelComponentType) << " bytes");
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::AutotuneFFT(const InputImageSizeType & size,
+                                                                                FFTBackendEnum &           backend,
+                                                                                FFTPlanRigorEnum &         rigor)
+{
+  using FFTWTraits = PhaseSymmetryFFTWTraits<ComplexPixelComponentType>;
+  const std::string wisdomFileName = m_FFTTuningFileName.empty() ? std::string() : m_FFTTuningFileName + ".wisdom";
+  if (!wisdomFileName.empty())
+  {
+    FFTWTraits::ImportWisdom(wisdomFileName);
+  }
+
+  // A tuning entry is the pixel precision, the size, the backend and the
+  // plan rigor, separated by white space
+  std::ostringstream key;
+  key << sizeof(ComplexPixelComponentType);
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+  {
+    key << ' ' << size[i];
+  }
+
+  // The tunings found by this process, so that filters without a tuning file
+  // measure each size once. The mutex is only held to look up and record a
+  // tuning, so that filters of tuned sizes do not wait behind a measurement.
+  static std::mutex                                                           tuningsMutex;
+  static std::map<std::string, std::pair<FFTBackendEnum, FFTPlanRigorEnum>> tunings;
+  {
+    std::lock_guard<std::mutex> tuningsLock(tuningsMutex);
+    const auto                  tuned = tunings.find(key.str());
+    if (tuned != tunings.end())
+    {
+      itkDebugMacro("Reusing tuned FFT " << tuned->second.first << " " << tuned->second.second << " for " << size);
+      backend = tuned->second.first;
+      rigor = tuned->second.second;
+      return;
+    }
+  }
+
+  std::vector<std::string> tuningLines;
+  if (!m_FFTTuningFileName.empty())
+  {
+    std::ifstream tuningFile(m_FFTTuningFileName.c_str());
+    std::string   line;
+    while (std::getline(tuningFile, line))
+    {
+      tuningLines.push_back(line);
+      if (line.compare(0, key.str().size(), key.str()) != 0 || line.size() <= key.str().size() ||
+          line[key.str().size()] != ' ')
+      {
+        continue;
       }
-      else if (m_Polarity == -1)
+      std::istringstream entry(line.substr(key.str().size()));
+      std::string        backendName;
+      std::string        rigorName;
+      entry >> backendName >> rigorName;
+      for (FFTBackendEnum candidate : { FFTBackendEnum::VNL, FFTBackendEnum::FFTW })
       {
-        m_AbsImageFilter->SetInput(m_C2IFilter->GetOutput());
-        m_NegateFilter->SetInput(m_C2RFilter->GetOutput());
-        m_NegateFilter2->SetInput(m_AbsImageFilter->GetOutput());
+        std::ostringstream name;
+        name << candidate;
+        if (name.str() == backendName)
+        {
+          for (FFTPlanRigorEnum candidateRigor : { FFTPlanRigorEnum::Estimate,
+                                                   FFTPlanRigorEnum::Measure,
+                                                   FFTPlanRigorEnum::Patient,
+                                                   FFTPlanRigorEnum::Exhaustive })
+          {
+            std::ostringstream candidateRigorName;
+            candidateRigorName << candidateRigor;
+            if (candidateRigorName.str() == rigorName)
+            {
+              itkDebugMacro("Reusing tuned FFT " << candidate << " " << candidateRigor << " for " << size);
+              backend = candidate;
+              rigor = candidateRigor;
+              std::lock_guard<std::mutex> tuningsLock(tuningsMutex);
+              tunings[key.str()] = std::make_pair(backend, rigor);
+              return;
+            }
+          }
+        }
+      }
+    }
+  }
 
-        m_AddImageFilter->SetInput1(m_NegateFilter->GetOutput());
-        m_AddImageFilter->SetInput2(m_NegateFilter2->GetOutput());
+  // Measure the candidates on images of the input size. The first run of
+  // each candidate creates its plans and touches its buffers, and is not
+  // timed; the candidate then takes the best of several timed runs.
+  typename FloatImageType::RegionType region;
+  region.SetSize(size);
+  typename FloatImageType::Pointer realImage = FloatImageType::New();
+  realImage->SetRegions(region);
+  realImage->Allocate();
+  realImage->FillBuffer(NumericTraits<ComputePixelType>::ZeroValue());
+  typename ComplexImageType::Pointer complexImage = ComplexImageType::New();
+  complexImage->SetRegions(region);
+  complexImage->Allocate();
+  complexImage->FillBuffer(ComplexPixelType(0, 0));
+
+  std::vector<std::pair<FFTBackendEnum, FFTPlanRigorEnum>> candidates;
+  bool                                                     vnlSizeIsLegal = true;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+  {
+    SizeValueType n = size[i];
+    for (SizeValueType factor : { 2, 3, 5 })
+    {
+      while (n > 1 && n % factor == 0)
+      {
+        n /= factor;
+      }
+    }
+    vnlSizeIsLegal &= (n == 1);
+  }
+  if (vnlSizeIsLegal)
+  {
+    candidates.emplace_back(FFTBackendEnum::VNL, FFTPlanRigorEnum::Estimate);
+  }
+  if (FFTWTraits::Available::value)
+  {
+    candidates.emplace_back(FFTBackendEnum::FFTW, FFTPlanRigorEnum::Estimate);
+    candidates.emplace_back(FFTBackendEnum::FFTW, FFTPlanRigorEnum::Measure);
+    candidates.emplace_back(FFTBackendEnum::FFTW, FFTPlanRigorEnum::Patient);
+  }
+  if (candidates.empty())
+  {
+    backend = FFTBackendEnum::Default;
+    rigor = m_FFTPlanRigor;
+    return;
+  }
 
-        m_AddImageFilter2->SetInput1(m_AddImageFilter->GetOutput());
-        m_AddImageFilter2->SetInput2(EnergyThisOrient);
+  constexpr unsigned int numberOfTimedRuns = 3;
+  double                 bestTime = std::numeric_limits<double>::max();
+  for (const auto & candidate : candidates)
+  {
+    this->CreateFFTFilters(candidate.first, candidate.second);
+    m_FFTFilter->SetInput(realImage);
+    m_IFFTFilter->SetInput(complexImage);
+    m_FFTFilter->Update();
+    m_IFFTFilter->Update();
+
+    double candidateTime = std::numeric_limits<double>::max();
+    for (unsigned int run = 0; run < numberOfTimedRuns; ++run)
+    {
+      m_FFTFilter->Modified();
+      m_IFFTFilter->Modified();
+      TimeProbe probe;
+      probe.Start();
+      m_FFTFilter->Update();
+      m_IFFTFilter->Update();
+      probe.Stop();
+      candidateTime = std::min(candidateTime, probe.GetTotal());
+    }
+    itkDebugMacro("FFT " << candidate.first << " " << candidate.second << ": " << candidateTime << " s");
 
-        m_AddImageFilter2->Update();
-        EnergyThisOrient = m_AddImageFilter2->GetOutput();
-        EnergyThisOrient->DisconnectPipeline();
-      }
+    if (candidateTime < bestTime)
+    {
+      bestTime = candidateTime;
+      backend = candidate.first;
+      rigor = candidate.second;
     }
+  }
 
-    // Subtract the values below the noise threshold
-    m_ShiftScaleFilter->SetInput(EnergyThisOrient);
-    m_ShiftScaleFilter->SetScale(1.0);
-    m_ShiftScaleFilter->SetShift(-m_NoiseThreshold);
+  // The tuning file is also written under the mutex, as the filters of this
+  // process share its temporary file
+  std::lock_guard<std::mutex> tuningsLock(tuningsMutex);
+  tunings[key.str()] = std::make_pair(backend, rigor);
 
-    m_AddImageFilter->SetInput1(m_ShiftScaleFilter->GetOutput());
-    m_AddImageFilter->SetInput2(totalEnergy);
-    m_AddImageFilter->Update();
+  if (!m_FFTTuningFileName.empty())
+  {
+    // Write the tunings read above and the new one to a file private to this
+    // process and rename it over the tuning file, so that processes tuning
+    // concurrently cannot interleave records. A record written by another
+    // process in the meantime may be dropped, and is then measured again.
+    const std::string processSuffix = ".tmp." + std::to_string(itksys::SystemInformation().GetProcessId());
+    const std::string temporaryFileName = m_FFTTuningFileName + processSuffix;
+    std::ofstream     tuningFile(temporaryFileName.c_str(), std::ios::trunc);
+    for (const auto & line : tuningLines)
+    {
+      tuningFile << line << '\n';
+    }
+    tuningFile << key.str() << ' ' << backend << ' ' << rigor << '\n';
+    tuningFile.close();
+    if (!tuningFile || !Self::ReplaceFile(temporaryFileName, m_FFTTuningFileName))
+    {
+      itkWarningMacro(<< "Could not record the FFT tuning in " << m_FFTTuningFileName);
+      std::remove(temporaryFileName.c_str());
+    }
 
-    totalEnergy = m_AddImageFilter->GetOutput();
-    totalEnergy->DisconnectPipeline();
+    const std::string temporaryWisdomFileName = wisdomFileName + processSuffix;
+    if (FFTWTraits::ExportWisdom(temporaryWisdomFileName) &&
+        !Self::ReplaceFile(temporaryWisdomFileName, wisdomFileName))
+    {
+      std::remove(temporaryWisdomFileName.c_str());
+    }
   }
+}
 
-  // Set negative values to zero
-  m_ShiftScaleFilter->SetScale(0.0);
-  m_ShiftScaleFilter->SetShift(0.0);
-  m_MaxImageFilter->SetInput1(totalEnergy);
-  m_MaxImageFilter->SetInput2(m_ShiftScaleFilter->GetOutput());
 
-  // Divide total energy by total amplitude over all scales and orientations
-  m_DivideImageFilter->SetInput1(m_MaxImageFilter->GetOutput());
-  m_DivideImageFilter->SetInput2(totalAmplitude);
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::FloatImageType::Pointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ComposeFilterBankEntry(
+  const FloatImageType * scaleFactor,
+  const FloatImageType * orientationFactor) const
+{
+  // The factors are in FFT layout already
+  typename FloatImageType::Pointer entry = FloatImageType::New();
+  entry->CopyInformation(scaleFactor);
+  entry->SetRegions(scaleFactor->GetBufferedRegion());
+  entry->Allocate();
+  const ComputePixelType * scaleBuffer = scaleFactor->GetBufferPointer();
+  const ComputePixelType * orientationBuffer = orientationFactor->GetBufferPointer();
+  ComputePixelType *       entryBuffer = entry->GetBufferPointer();
+  const SizeValueType      count = scaleFactor->GetBufferedRegion().GetNumberOfPixels();
+  for (SizeValueType i = 0; i < count; ++i)
+  {
+    entryBuffer[i] = scaleBuffer[i] * orientationBuffer[i];
+  }
+  return entry;
+}
+
 
-  m_DivideImageFilter->GraftOutput(this->GetOutput());
-  m_DivideImageFilter->Update();
-  m_PhaseSymmetry = m_DivideImageFilter->GetOutput();
-  this->GraftOutput(m_PhaseSymmetry);
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::FloatImageType::ConstPointer
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GetFilterBankEntry(unsigned int scale,
+                                                                                       unsigned int orientation) const
+{
+  if (!m_HalfFilterBank.empty())
+  {
+    const HalfImageType *            halfEntry = m_HalfFilterBank[scale][orientation];
+    typename FloatImageType::Pointer entry = FloatImageType::New();
+    entry->CopyInformation(halfEntry);
+    entry->SetRegions(halfEntry->GetBufferedRegion());
+    entry->Allocate();
+    const HalfPixelType * halfBuffer = halfEntry->GetBufferPointer();
+    ComputePixelType *    entryBuffer = entry->GetBufferPointer();
+    const SizeValueType   count = halfEntry->GetBufferedRegion().GetNumberOfPixels();
+    for (SizeValueType i = 0; i < count; ++i)
+    {
+      entryBuffer[i] = WidenFilterBankValue(halfBuffer[i]);
+    }
+    return entry.GetPointer();
+  }
+  if (m_FilterBankIsPrecomputed)
+  {
+    return m_FilterBank[scale][orientation].GetPointer();
+  }
+  return this->ComposeFilterBankEntry(m_ScaleFactors[scale], m_OrientationFactors[orientation]).GetPointer();
 }
 
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
 void
-PhaseSymmetryImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::ComputeDistinctOrientations(
+  MatrixType &                distinctOrientations,
+  std::vector<unsigned int> & multiplicities) const
 {
-  itkDebugMacro("GenerateInputRequestedRegion Start");
-  Superclass::GenerateInputRequestedRegion();
+  constexpr double foldedTolerance = 1e-9;
 
-  if (this->GetInput())
+  const unsigned int              dimension = m_Orientations.cols();
+  std::vector<vnl_vector<double>> rows;
+  std::vector<vnl_vector<double>> directions;
+  multiplicities.clear();
+  for (unsigned int o = 0; o < m_Orientations.rows(); ++o)
   {
-    typename TInputImage::RegionType RequestedRegion;
-    typename TInputImage::SizeType   inputSize;
-    typename TInputImage::IndexType  inputIndex;
-    typename TInputImage::SizeType   inputLargSize;
-    typename TInputImage::IndexType  inputLargIndex;
-    typename TOutputImage::SizeType  outputSize;
-    typename TOutputImage::IndexType outputIndex;
+    vnl_vector<double> row = m_Orientations.get_row(o);
+    const double       norm = row.two_norm();
+    if (m_CanonicalizeOrientations)
+    {
+      for (unsigned int dim = 0; dim < dimension; ++dim)
+      {
+        if (row[dim] != 0.0)
+        {
+          if (row[dim] < 0.0)
+          {
+            row *= -1.0;
+          }
+          break;
+        }
+      }
+    }
+    const vnl_vector<double> direction = norm > 0.0 ? row / norm : row;
 
-    outputIndex = this->GetOutput()->GetRequestedRegion().GetIndex();
-    outputSize = this->GetOutput()->GetRequestedRegion().GetSize();
-    inputLargSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
-    inputLargIndex = this->GetInput()->GetLargestPossibleRegion().GetIndex();
+    // Null orientations are never merged
+    std::size_t match = directions.size();
+    if (norm > 0.0)
+    {
+      for (match = 0; match < directions.size(); ++match)
+      {
+        bool same = direction == directions[match] || direction == -directions[match];
+        if (m_CanonicalizeOrientations)
+        {
+          // Near the boundary of the half-sphere, folding may separate
+          // directions that are opposite up to rounding
+          same = same || (direction - directions[match]).two_norm() <= foldedTolerance ||
+                 (direction + directions[match]).two_norm() <= foldedTolerance;
+        }
+        if (same)
+        {
+          break;
+        }
+      }
+    }
+    if (match < directions.size())
+    {
+      ++multiplicities[match];
+      continue;
+    }
+    rows.push_back(row);
+    directions.push_back(direction);
+    multiplicities.push_back(1);
+  }
+
+  distinctOrientations.SetSize(rows.size(), dimension);
+  for (unsigned int o = 0; o < rows.size(); ++o)
+  {
+    distinctOrientations.set_row(o, rows[o]);
+  }
+}
 
-    for (unsigned int i = 0; i < TInputImage::ImageDimension; i++)
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CostEstimateType
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::EstimateCost(const InputImageSizeType & size,
+                                                                                 bool precomputeFilterBank) const
+{
+  // Approximate per-voxel costs, in floating point operations, of the stages
+  // of the pipeline. A transcendental function counts as ten.
+  constexpr double flopsPerScaleFactorVoxel = 60.0;       // log gabor and butterworth
+  constexpr double flopsPerOrientationFactorVoxel = 50.0; // steerable filter
+  constexpr double flopsPerEntryCompositionVoxel = 1.0;   // product
+  constexpr double flopsPerBandPassVoxel = 7.0;           // gain widening, scaling and complex product
+  constexpr double flopsPerAccumulationVoxel = 25.0;      // modulus, energy and sums
+
+  MatrixType                distinctOrientations;
+  std::vector<unsigned int> multiplicities;
+  this->ComputeDistinctOrientations(distinctOrientations, multiplicities);
+
+  const SizeValueType scales = m_Wavelengths.rows();
+  const SizeValueType orientations = distinctOrientations.rows();
+  const SizeValueType entries = scales * orientations;
+
+  SizeValueType pixels = 1;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+  {
+    pixels *= size[i];
+  }
+  const double pixelCount = static_cast<double>(pixels);
+  const double fftFlops = pixels > 1 ? 5.0 * pixelCount * std::log2(pixelCount) : 0.0;
+
+  // The inverse FFTs and accumulation run at the decimated output size
+  const InputImageSizeType outputSize = PlanType::ComputeDecimatedSize(size, m_DecimationFactor);
+  SizeValueType            outputPixels = 1;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+  {
+    outputPixels *= outputSize[i];
+  }
+  const double outputPixelCount = static_cast<double>(outputPixels);
+  const double inverseFFTFlops = outputPixels > 1 ? 5.0 * outputPixelCount * std::log2(outputPixelCount) : 0.0;
+
+  CostEstimateType estimate;
+  estimate.PrecomputeFilterBank = precomputeFilterBank;
+  // A shard transforms the input only if it is shard 0, and computes its
+  // range of the entries
+  const SizeValueType shardEntries =
+    entries * (m_ShardIndex + 1) / m_NumberOfShards - entries * m_ShardIndex / m_NumberOfShards;
+  const bool sharded = m_NumberOfShards > 1;
+  estimate.NumberOfForwardFFTs = sharded && m_ShardIndex > 0 ? 0 : 1;
+  estimate.NumberOfInverseFFTs = sharded ? shardEntries : entries;
+
+  const SizeValueType realBytes = pixels * sizeof(ComplexPixelComponentType);
+  const SizeValueType complexBytes = pixels * sizeof(ComplexPixelType);
+  const SizeValueType outputRealBytes = outputPixels * sizeof(ComplexPixelComponentType);
+  const SizeValueType outputComplexBytes = outputPixels * sizeof(ComplexPixelType);
+  const SizeValueType factorBytes = (scales + orientations) * realBytes;
+  const SizeValueType entryBytes = m_HalfPrecisionFilterBank ? pixels * sizeof(HalfPixelType) : realBytes;
+  const SizeValueType bankBytes = precomputeFilterBank ? entries * entryBytes : factorBytes;
+
+  // Initialize() holds the outputs of the filter bank source: the factors,
+  // the entries, or the entries of one scale with the half precision bank.
+  SizeValueType initializePeak = precomputeFilterBank ? bankBytes : factorBytes;
+  if (precomputeFilterBank && m_HalfPrecisionFilterBank)
+  {
+    initializePeak += orientations * realBytes;
+  }
+
+  // Progressive updates add the partial result, and per scale the copy of
+  // the total energy it is computed from.
+  SizeValueType progressiveBytes = 0;
+  if (m_ProgressiveUpdates != ProgressiveUpdatesEnum::Off)
+  {
+    progressiveBytes = outputPixels * sizeof(OutputImagePixelType);
+    if (m_ProgressiveUpdates == ProgressiveUpdatesEnum::PerScale)
     {
-      inputSize[i] = outputSize[i];
-      inputIndex[i] = outputIndex[i];
+      progressiveBytes += outputRealBytes;
     }
+  }
+
+  // A decimated plan holds, for as long as it lives, the table of the input
+  // bins that each output bin gathers and the offsets of each bin into it.
+  // Along an axis, every output bin gathers one input bin, and the Nyquist
+  // bin of an even, smaller output size one more.
+  SizeValueType gatherBytes = 0;
+  if (outputPixels != pixels)
+  {
+    SizeValueType sourceIndices = 1;
+    for (unsigned int i = 0; i < InputImageDimension; ++i)
+    {
+      sourceIndices *= outputSize[i] + (outputSize[i] < size[i] && outputSize[i] % 2 == 0 ? 1 : 0);
+    }
+    gatherBytes = (sourceIndices + outputPixels + 1) * sizeof(SizeValueType);
+  }
+
+  // The shared memory of a sharded job replaces the input spectrum, and adds
+  // the shared accumulators.
+  const SizeValueType sharedBytes = sharded ? 2 * outputRealBytes : 0;
+
+  // GenerateData() holds the bank, the input spectrum, and at the output
+  // size three accumulators and the band-passed spectrum with the transform
+  // output and work buffer; the factored bank composes each entry within the
+  // band-pass product.
+  const SizeValueType generateDataPeak =
+    bankBytes + complexBytes + 3 * outputRealBytes + 3 * outputComplexBytes + progressiveBytes + sharedBytes;
+
+  // The forward FFT holds the bank, the spectrum with its work buffer, and
+  // an input of another pixel type converted to the compute type, unless the
+  // VNL plan or FFTW convert it as they transform it.
+  const bool convertInput =
+    !std::is_same<InputImageType, FloatImageType>::value &&
+    dynamic_cast<VnlForwardFFTImageFilter<FloatImageType, ComplexImageType> *>(m_FFTFilter.GetPointer()) == nullptr &&
+    !this->ConvertsInputInFFTWSpectrum(FFTWConvertsInputType());
+  const SizeValueType forwardFFTPeak = bankBytes + (convertInput ? realBytes : 0) + 2 * complexBytes;
+
+  estimate.PeakMemoryInBytes = pixels * sizeof(InputImagePixelType) + outputPixels * sizeof(OutputImagePixelType) +
+                               gatherBytes + std::max(initializePeak, std::max(generateDataPeak, forwardFFTPeak));
+
+  double flops = pixelCount * (scales * flopsPerScaleFactorVoxel + orientations * flopsPerOrientationFactorVoxel);
+  flops += pixelCount * entries * flopsPerEntryCompositionVoxel;
+  flops += fftFlops * estimate.NumberOfForwardFFTs + inverseFFTFlops * estimate.NumberOfInverseFFTs;
+  flops += outputPixelCount * estimate.NumberOfInverseFFTs * (flopsPerBandPassVoxel + flopsPerAccumulationVoxel);
+  estimate.FloatingPointOperations = flops;
+
+  return estimate;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::CostEstimateType
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::EstimateCost() const
+{
+  const InputImageType * input = this->GetInput();
+  if (!input)
+  {
+    itkExceptionMacro(<< "An input is required to estimate the cost");
+  }
+  const InputImageSizeType size = input->GetLargestPossibleRegion().GetSize();
+
+  return this->EstimateCost(size, this->SelectPrecomputeFilterBank(size));
+}
+
 
-    RequestedRegion.SetSize(inputSize);
-    RequestedRegion.SetIndex(inputIndex);
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+bool
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::SelectPrecomputeFilterBank(
+  const InputImageSizeType & size) const
+{
+  if (m_MemoryBudget == 0)
+  {
+    return m_PrecomputeFilterBank;
+  }
+  const CostEstimateType requestedCost = this->EstimateCost(size, m_PrecomputeFilterBank);
+  if (requestedCost.PeakMemoryInBytes <= m_MemoryBudget)
+  {
+    return m_PrecomputeFilterBank;
+  }
+  const CostEstimateType alternativeCost = this->EstimateCost(size, !m_PrecomputeFilterBank);
+  if (alternativeCost.PeakMemoryInBytes < requestedCost.PeakMemoryInBytes)
+  {
+    return !m_PrecomputeFilterBank;
+  }
+  return m_PrecomputeFilterBank;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GenerateInputRequestedRegion()
+{
+  itkDebugMacro("GenerateInputRequestedRegion Start");
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput() && m_SliceWise)
+  {
+    // Every output pixel depends on the whole of its slice
+    InputImagePointer    input = const_cast<TInputImage *>(this->GetInput());
+    InputImageRegionType region = input->GetLargestPossibleRegion();
+    region.SetIndex(m_SliceAxis, this->GetOutput()->GetRequestedRegion().GetIndex(m_SliceAxis));
+    region.SetSize(m_SliceAxis, this->GetOutput()->GetRequestedRegion().GetSize(m_SliceAxis));
+    input->SetRequestedRegion(region);
+  }
+  else if (this->GetInput())
+  {
+    // Every output pixel depends on the whole input, whose buffer the
+    // forward FFT reads at its largest possible size
     InputImagePointer input = const_cast<TInputImage *>(this->GetInput());
-    input->SetRequestedRegion(RequestedRegion);
+    input->SetRequestedRegionToLargestPossibleRegion();
   }
 }
 
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
 void
-PhaseSymmetryImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::GenerateOutputInformation()
 {
   Superclass::GenerateOutputInformation();
 
@@ -455,15 +1796,34 @@ PhaseSymmetryImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
   inSpacing = input->GetSpacing();
   inOrigin = input->GetOrigin();
 
-  // Set the LargestPossibleRegion of the output.
-
+  // Set the LargestPossibleRegion of the output. When decimated, output
+  // pixel i samples the input at inputSize / outputSize times i, from the
+  // same start index and its physical point.
+  const InputImageSizeType decimatedSize = PlanType::ComputeDecimatedSize(inputSize, m_DecimationFactor);
   for (unsigned int i = 0; i < InputImageDimension; i++)
   {
-    outputSize[i] = inputSize[i];
+    outputSize[i] = decimatedSize[i];
     outputIndex[i] = inputIndex[i];
     outSpacing[i] = inSpacing[i];
+    if (outputSize[i] != inputSize[i])
+    {
+      outSpacing[i] *= double(inputSize[i]) / double(outputSize[i]);
+    }
     outOrigin[i] = inOrigin[i];
   }
+  if (m_DecimationFactor > 1)
+  {
+    typename TInputImage::PointType startPoint;
+    input->TransformIndexToPhysicalPoint(inputIndex, startPoint);
+    for (unsigned int i = 0; i < InputImageDimension; i++)
+    {
+      outOrigin[i] = startPoint[i];
+      for (unsigned int j = 0; j < InputImageDimension; j++)
+      {
+        outOrigin[i] -= input->GetDirection()[i][j] * outSpacing[j] * double(outputIndex[j]);
+      }
+    }
+  }
 
   // Set the size of the output region
   outputRegion.SetSize(outputSize);
@@ -477,13 +1837,33 @@ PhaseSymmetryImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
 }
 
 
-template <typename TInputImage, typename TOutputImage>
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
 void
-PhaseSymmetryImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
 
   //  os << indent << " Integral Filter Normalize By: " << m_Cutoff << std::endl;
+  os << indent << "AngularTolerance: " << m_AngularTolerance << std::endl;
+  os << indent << "CanonicalizeOrientations: " << m_CanonicalizeOrientations << std::endl;
+  os << indent << "DecimationFactor: " << m_DecimationFactor << std::endl;
+  os << indent << "SliceWise: " << m_SliceWise << std::endl;
+  os << indent << "SliceAxis: " << m_SliceAxis << std::endl;
+  os << indent << "PrecomputeFilterBank: " << m_PrecomputeFilterBank << std::endl;
+  os << indent << "HalfPrecisionFilterBank: " << m_HalfPrecisionFilterBank << std::endl;
+  os << indent << "MemoryBudget: " << m_MemoryBudget << std::endl;
+  os << indent << "FFTBackend: " << m_FFTBackend << std::endl;
+  os << indent << "FFTPlanRigor: " << m_FFTPlanRigor << std::endl;
+  os << indent << "FFTTuningFileName: " << m_FFTTuningFileName << std::endl;
+  os << indent << "CheckpointFileName: " << m_CheckpointFileName << std::endl;
+  os << indent << "CheckpointInterval: " << m_CheckpointInterval << std::endl;
+  os << indent << "ProgressiveUpdates: " << m_ProgressiveUpdates << std::endl;
+  os << indent << "NumberOfShards: " << m_NumberOfShards << std::endl;
+  os << indent << "ShardIndex: " << m_ShardIndex << std::endl;
+  os << indent << "SharedMemoryName: " << m_SharedMemoryName << std::endl;
+  os << indent << "ShardRunIdentifier: " << m_ShardRunIdentifier << std::endl;
+  os << indent << "ShardTimeout: " << m_ShardTimeout << std::endl;
+  os << indent << "NumberOfResumedOrientations: " << m_NumberOfResumedOrientations << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,335 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryPlan_h
+#define itkPhaseSymmetryPlan_h
+
+#include "itkImage.h"
+#include "itkLightObject.h"
+#include "itkObjectFactory.h"
+#include "itkPhaseSymmetryHalfFloat.h"
+#include "itkVnlFFTCommon.h"
+
+#include <complex>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+class PhaseSymmetryImageFilter;
+
+/** \class PhaseSymmetryPlan
+ * \brief Immutable description of a phase symmetry computation for one image
+ * size: the filter bank, the distinct orientations and their weights, the
+ * polarity and the noise threshold.
+ *
+ * A plan is built by PhaseSymmetryImageFilter::Initialize() and obtained
+ * through GetPlan(). It is never modified afterwards, and a later
+ * Initialize() builds a new plan, so that a plan may be shared by any number
+ * of threads. Every method is const; the mutable state of a computation, the
+ * FFT plan and the intermediate buffers, lives in a ScratchType that each
+ * thread owns.
+ *
+ * Execute() computes the phase symmetry of a pixel buffer of the plan size,
+ * x fastest, into a buffer of the output size, with the VNL FFT, which
+ * requires sizes with prime factors 2, 3 and 5 only. Its steps are also
+ * available separately, over [begin, end) ranges of pixels where they are
+ * pointwise, so that a caller may divide the orientations or the pixels of
+ * one image between threads.
+ *
+ * With a decimation factor f, the output size is the plan size divided by f
+ * along every axis. Each band-passed spectrum is truncated to the frequencies
+ * of the output grid before its inverse transform, so that the inverse FFTs
+ * and the accumulation run at the output size; the output samples the full
+ * resolution result every f pixels, up to the band-passed content beyond the
+ * Nyquist frequency of the output grid.
+ *
+ * \sa PhaseSymmetryImageFilter
+ *
+ * \ingroup PhaseSymmetry
+ */
+template <typename TInputImage,
+          typename TOutputImage,
+          typename TComputePixel = typename NumericTraits<typename TOutputImage::PixelType>::FloatType>
+class PhaseSymmetryPlan : public LightObject
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PhaseSymmetryPlan);
+
+  /** Standard class type alias. */
+  using Self = PhaseSymmetryPlan;
+  using Superclass = LightObject;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PhaseSymmetryPlan, LightObject);
+
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using InputPixelType = typename TInputImage::PixelType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using ComputePixelType = TComputePixel;
+  using ComplexPixelType = std::complex<ComputePixelType>;
+  using SizeType = typename TInputImage::SizeType;
+
+  using FloatImageType = Image<ComputePixelType, ImageDimension>;
+  using HalfPixelType = PhaseSymmetryHalfFloat::StorageType;
+  using HalfImageType = Image<HalfPixelType, ImageDimension>;
+  using FFTTransformType = typename VnlFFTCommon::VnlFFTTransform<FloatImageType>;
+
+  /** \struct ScratchType
+   * \brief The FFT plans and buffers of one thread. AllocateScratch()
+   * prepares it for a plan; Execute() does so when it is not prepared for
+   * the sizes of the plan. The spectrum has the plan size, and the other
+   * buffers the output size.
+   *
+   * \ingroup PhaseSymmetry
+   */
+  struct ScratchType
+  {
+    SizeType                          Size;
+    SizeType                          OutputSize;
+    std::unique_ptr<FFTTransformType> Transform;
+    std::unique_ptr<FFTTransformType> OutputTransform;
+    std::vector<ComplexPixelType>     Spectrum;
+    std::vector<ComplexPixelType>     BandPass;
+    std::vector<ComputePixelType>     Amplitude;
+    std::vector<ComputePixelType>     Energy;
+    std::vector<ComputePixelType>     OrientationEnergy;
+  };
+
+  const SizeType &
+  GetSize() const
+  {
+    return m_Size;
+  }
+
+  SizeValueType
+  GetNumberOfPixels() const
+  {
+    return m_NumberOfPixels;
+  }
+
+  const SizeType &
+  GetOutputSize() const
+  {
+    return m_OutputSize;
+  }
+
+  SizeValueType
+  GetNumberOfOutputPixels() const
+  {
+    return m_NumberOfOutputPixels;
+  }
+
+  unsigned int
+  GetDecimationFactor() const
+  {
+    return m_DecimationFactor;
+  }
+
+  /** Get the output size for a decimation factor: the size divided by the
+   * factor, rounded down, and at least 1 along every axis. */
+  static SizeType
+  ComputeDecimatedSize(const SizeType & size, unsigned int decimationFactor);
+
+  unsigned int
+  GetNumberOfScales() const
+  {
+    return m_NumberOfScales;
+  }
+
+  /** Get the number of distinct orientations, each of which stands for
+   * GetOrientationMultiplicity() orientations of the filter. */
+  unsigned int
+  GetNumberOfDistinctOrientations() const
+  {
+    return static_cast<unsigned int>(m_OrientationMultiplicities.size());
+  }
+
+  unsigned int
+  GetOrientationMultiplicity(unsigned int orientation) const
+  {
+    return m_OrientationMultiplicities[orientation];
+  }
+
+  int
+  GetPolarity() const
+  {
+    return m_Polarity;
+  }
+
+  double
+  GetNoiseThreshold() const
+  {
+    return m_NoiseThreshold;
+  }
+
+  /** Whether the plan and output sizes have prime factors 2, 3 and 5 only,
+   * as the VNL FFTs of Execute() require. */
+  bool
+  IsSizeSupported() const;
+
+  /** Allocate the FFT plan and the buffers of a scratch for this plan.
+   * Throws if the size is not supported. */
+  void
+  AllocateScratch(ScratchType & scratch) const;
+
+  /** Compute the phase symmetry of an input buffer of the plan size into an
+   * output buffer of the output size. Safe to call concurrently with
+   * distinct scratches. */
+  void
+  Execute(const InputPixelType * input, OutputPixelType * output, ScratchType & scratch) const;
+
+  /** Convert an input buffer to the compute type and compute its spectrum,
+   * with the forward transform of the plan size. */
+  void
+  ForwardTransform(const InputPixelType * input, ComplexPixelType * spectrum, FFTTransformType & transform) const;
+
+  /** Multiply a spectrum of the plan size by the filter bank entry of a scale
+   * and a distinct orientation, weighted by the multiplicity of the
+   * orientation and normalized by the number of pixels, into pixels
+   * [begin, end) of a band-passed spectrum of the output size. When
+   * decimated, each output bin gathers the input bin of the same signed
+   * frequency, or both Nyquist bins of an even output size, whose responses
+   * coincide on the output grid. */
+  void
+  BandPass(unsigned int             scale,
+           unsigned int             orientation,
+           const ComplexPixelType * spectrum,
+           ComplexPixelType *       bandPass,
+           SizeValueType            begin,
+           SizeValueType            end) const;
+
+  /** Add the amplitude and the energy, for the polarity of the plan, of
+   * pixels [begin, end) of the response to a band-passed spectrum. */
+  void
+  AccumulateResponse(const ComplexPixelType * response,
+                     ComputePixelType *       amplitude,
+                     ComputePixelType *       orientationEnergy,
+                     SizeValueType            begin,
+                     SizeValueType            end) const;
+
+  /** Add the energy of a distinct orientation over every scale, less the
+   * noise threshold of the orientations it stands for, to the total energy
+   * of pixels [begin, end). */
+  void
+  AccumulateEnergy(unsigned int             orientation,
+                   const ComputePixelType * orientationEnergy,
+                   ComputePixelType *       energy,
+                   SizeValueType            begin,
+                   SizeValueType            end) const;
+
+  /** Add the amplitude and the thresholded energy of a distinct orientation,
+   * over every scale, to the totals of a whole output image. Uses the
+   * band-pass and orientation energy buffers and the output FFT plan of the
+   * scratch. */
+  void
+  AccumulateOrientation(unsigned int             orientation,
+                        const ComplexPixelType * spectrum,
+                        ComputePixelType *       amplitude,
+                        ComputePixelType *       energy,
+                        ScratchType &            scratch) const;
+
+  /** Set negative total energies to zero and divide them by the total
+   * amplitudes of pixels [begin, end), in the output pixel type. A zero
+   * amplitude gives the maximum of the output pixel type. */
+  void
+  ComputeOutput(const ComputePixelType * amplitude,
+                const ComputePixelType * energy,
+                OutputPixelType *        output,
+                SizeValueType            begin,
+                SizeValueType            end) const;
+
+  /** Convert a phase symmetry value to the output pixel type: as is for a
+   * real output, clamped to [0, 1] and rescaled to [0, max] for an integer
+   * output. */
+  static OutputPixelType
+  ConvertToOutputPixel(ComputePixelType value)
+  {
+    return ConvertToOutputPixel(value, std::integral_constant<bool, NumericTraits<OutputPixelType>::is_integer>());
+  }
+
+protected:
+  PhaseSymmetryPlan() = default;
+  ~PhaseSymmetryPlan() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  static OutputPixelType
+  ConvertToOutputPixel(ComputePixelType value, std::false_type);
+  static OutputPixelType
+  ConvertToOutputPixel(ComputePixelType value, std::true_type);
+
+  /** Multiply the spectrum by weight * gain(i) at input bin i, gathered into
+   * the output bins [begin, end). */
+  template <typename TGain>
+  void
+  GatherBandPass(const ComplexPixelType * spectrum,
+                 ComplexPixelType *       bandPass,
+                 ComputePixelType         weight,
+                 TGain                    gain,
+                 SizeValueType            begin,
+                 SizeValueType            end) const;
+
+private:
+  // The filter builds its plans
+  friend class PhaseSymmetryImageFilter<TInputImage, TOutputImage, TComputePixel>;
+
+  itkNewMacro(Self);
+
+  /** Set the output size and the input bins each output bin gathers, for
+   * the plan size and a decimation factor. */
+  void
+  SetDecimationFactor(unsigned int decimationFactor);
+
+  SizeType                  m_Size;
+  SizeValueType             m_NumberOfPixels{ 0 };
+  SizeType                  m_OutputSize;
+  SizeValueType             m_NumberOfOutputPixels{ 0 };
+  unsigned int              m_DecimationFactor{ 1 };
+  unsigned int              m_NumberOfScales{ 0 };
+  std::vector<unsigned int> m_OrientationMultiplicities;
+  int                       m_Polarity{ 0 };
+  double                    m_NoiseThreshold{ 0.0 };
+
+  // One of the three forms of the filter bank, indexed scale-major for the
+  // entries
+  std::vector<typename FloatImageType::ConstPointer> m_FilterBank;
+  std::vector<typename HalfImageType::ConstPointer>  m_HalfFilterBank;
+  std::vector<typename FloatImageType::ConstPointer> m_ScaleFactors;
+  std::vector<typename FloatImageType::ConstPointer> m_OrientationFactors;
+
+  // The input bins m_SourceIndices[m_SourceOffsets[i]] up to
+  // m_SourceIndices[m_SourceOffsets[i + 1]] make output bin i; empty when
+  // the output is not decimated
+  std::vector<SizeValueType> m_SourceOffsets;
+  std::vector<SizeValueType> m_SourceIndices;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPhaseSymmetryPlan.hxx"
+#endif
+
+#endif
@@ -0,0 +1,414 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryPlan_hxx
+#define itkPhaseSymmetryPlan_hxx
+
+#include "itkPhaseSymmetryPlan.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+constexpr unsigned int PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::ImageDimension;
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::SizeType
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::ComputeDecimatedSize(const SizeType & size,
+                                                                                  unsigned int     decimationFactor)
+{
+  SizeType outputSize;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    outputSize[i] = std::max<SizeValueType>(1, size[i] / std::max(1u, decimationFactor));
+  }
+  return outputSize;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::SetDecimationFactor(unsigned int decimationFactor)
+{
+  m_DecimationFactor = std::max(1u, decimationFactor);
+  m_OutputSize = ComputeDecimatedSize(m_Size, m_DecimationFactor);
+  m_NumberOfOutputPixels = 1;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    m_NumberOfOutputPixels *= m_OutputSize[i];
+  }
+  m_SourceOffsets.clear();
+  m_SourceIndices.clear();
+  if (m_OutputSize == m_Size)
+  {
+    return;
+  }
+
+  // Along each axis, output bin m has the signed frequency m, or m - M past
+  // the middle, and gathers the input bin of that frequency. The Nyquist bin
+  // of an even output size M also gathers frequency +M/2, which is the same
+  // as -M/2 on the output grid.
+  std::vector<std::vector<std::vector<SizeValueType>>> axisSources(ImageDimension);
+  SizeValueType                                        stride = 1;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    const auto outputLength = static_cast<OffsetValueType>(m_OutputSize[i]);
+    const auto inputLength = static_cast<OffsetValueType>(m_Size[i]);
+    axisSources[i].resize(m_OutputSize[i]);
+    for (OffsetValueType m = 0; m < outputLength; ++m)
+    {
+      const OffsetValueType frequency = 2 * m < outputLength ? m : m - outputLength;
+      auto                  source = static_cast<SizeValueType>((frequency + inputLength) % inputLength);
+      axisSources[i][m].push_back(source * stride);
+      if (outputLength < inputLength && outputLength % 2 == 0 && 2 * m == outputLength)
+      {
+        source = static_cast<SizeValueType>(m);
+        axisSources[i][m].push_back(source * stride);
+      }
+    }
+    stride *= m_Size[i];
+  }
+
+  m_SourceOffsets.reserve(m_NumberOfOutputPixels + 1);
+  m_SourceOffsets.push_back(0);
+  std::vector<SizeValueType> sources;
+  std::vector<SizeValueType> extended;
+  for (SizeValueType outputIndex = 0; outputIndex < m_NumberOfOutputPixels; ++outputIndex)
+  {
+    sources.assign(1, 0);
+    SizeValueType remainder = outputIndex;
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+      const SizeValueType m = remainder % m_OutputSize[i];
+      remainder /= m_OutputSize[i];
+      extended.clear();
+      for (SizeValueType partial : sources)
+      {
+        for (SizeValueType offset : axisSources[i][m])
+        {
+          extended.push_back(partial + offset);
+        }
+      }
+      sources.swap(extended);
+    }
+    m_SourceIndices.insert(m_SourceIndices.end(), sources.begin(), sources.end());
+    m_SourceOffsets.push_back(m_SourceIndices.size());
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+bool
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::IsSizeSupported() const
+{
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+  {
+    if (m_Size[i] == 0 || !VnlFFTCommon::IsDimensionSizeLegal(m_Size[i]) ||
+        !VnlFFTCommon::IsDimensionSizeLegal(m_OutputSize[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::AllocateScratch(ScratchType & scratch) const
+{
+  if (!this->IsSizeSupported())
+  {
+    itkExceptionMacro(<< "Size " << m_Size << " and output size " << m_OutputSize
+                      << " must have prime factors 2, 3 and 5 only");
+  }
+  scratch.Size = m_Size;
+  scratch.OutputSize = m_OutputSize;
+  scratch.Transform.reset(new FFTTransformType(m_Size));
+  scratch.OutputTransform.reset(new FFTTransformType(m_OutputSize));
+  scratch.Spectrum.assign(m_NumberOfPixels, ComplexPixelType());
+  scratch.BandPass.assign(m_NumberOfOutputPixels, ComplexPixelType());
+  scratch.Amplitude.assign(m_NumberOfOutputPixels, ComputePixelType());
+  scratch.Energy.assign(m_NumberOfOutputPixels, ComputePixelType());
+  scratch.OrientationEnergy.assign(m_NumberOfOutputPixels, ComputePixelType());
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::Execute(const InputPixelType * input,
+                                                                     OutputPixelType *      output,
+                                                                     ScratchType &          scratch) const
+{
+  // A scratch of another plan of the same sizes is as good as one of this
+  // plan
+  if (!scratch.Transform || scratch.Size != m_Size || scratch.OutputSize != m_OutputSize)
+  {
+    this->AllocateScratch(scratch);
+  }
+
+  this->ForwardTransform(input, scratch.Spectrum.data(), *scratch.Transform);
+
+  std::fill(scratch.Amplitude.begin(), scratch.Amplitude.end(), NumericTraits<ComputePixelType>::ZeroValue());
+  std::fill(scratch.Energy.begin(), scratch.Energy.end(), NumericTraits<ComputePixelType>::ZeroValue());
+  for (unsigned int o = 0; o < this->GetNumberOfDistinctOrientations(); ++o)
+  {
+    this->AccumulateOrientation(o, scratch.Spectrum.data(), scratch.Amplitude.data(), scratch.Energy.data(), scratch);
+  }
+
+  this->ComputeOutput(scratch.Amplitude.data(), scratch.Energy.data(), output, 0, m_NumberOfOutputPixels);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::ForwardTransform(const InputPixelType * input,
+                                                                              ComplexPixelType *     spectrum,
+                                                                              FFTTransformType &     transform) const
+{
+  for (SizeValueType i = 0; i < m_NumberOfPixels; ++i)
+  {
+    spectrum[i] = ComplexPixelType(static_cast<ComputePixelType>(input[i]), 0);
+  }
+  transform.transform(spectrum, -1);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::BandPass(unsigned int             scale,
+                                                                      unsigned int             orientation,
+                                                                      const ComplexPixelType * spectrum,
+                                                                      ComplexPixelType *       bandPass,
+                                                                      SizeValueType            begin,
+                                                                      SizeValueType            end) const
+{
+  // The inverse transform is the forward one, normalized here by the number
+  // of pixels. The gains are real and non-negative, so this scales the
+  // magnitude and keeps the phase.
+  const auto weight = static_cast<ComputePixelType>(double(m_OrientationMultiplicities[orientation]) /
+                                                    double(m_NumberOfPixels));
+  const unsigned int entry = scale * this->GetNumberOfDistinctOrientations() + orientation;
+  if (!m_HalfFilterBank.empty())
+  {
+    const HalfPixelType * gain = m_HalfFilterBank[entry]->GetBufferPointer();
+    this->GatherBandPass(
+      spectrum,
+      bandPass,
+      weight,
+      [gain](SizeValueType i) { return static_cast<ComputePixelType>(PhaseSymmetryHalfFloat::ToFloat(gain[i])); },
+      begin,
+      end);
+  }
+  else if (!m_FilterBank.empty())
+  {
+    const ComputePixelType * gain = m_FilterBank[entry]->GetBufferPointer();
+    this->GatherBandPass(spectrum, bandPass, weight, [gain](SizeValueType i) { return gain[i]; }, begin, end);
+  }
+  else
+  {
+    // The entry is composed from its factors as it is applied
+    const ComputePixelType * scaleGain = m_ScaleFactors[scale]->GetBufferPointer();
+    const ComputePixelType * orientationGain = m_OrientationFactors[orientation]->GetBufferPointer();
+    this->GatherBandPass(
+      spectrum,
+      bandPass,
+      weight,
+      [scaleGain, orientationGain](SizeValueType i) -> ComputePixelType { return scaleGain[i] * orientationGain[i]; },
+      begin,
+      end);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+template <typename TGain>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::GatherBandPass(const ComplexPixelType * spectrum,
+                                                                            ComplexPixelType *       bandPass,
+                                                                            ComputePixelType         weight,
+                                                                            TGain                    gain,
+                                                                            SizeValueType            begin,
+                                                                            SizeValueType            end) const
+{
+  if (m_SourceOffsets.empty())
+  {
+    for (SizeValueType i = begin; i < end; ++i)
+    {
+      bandPass[i] = spectrum[i] * (weight * gain(i));
+    }
+    return;
+  }
+  for (SizeValueType i = begin; i < end; ++i)
+  {
+    ComplexPixelType sum;
+    for (SizeValueType s = m_SourceOffsets[i]; s < m_SourceOffsets[i + 1]; ++s)
+    {
+      const SizeValueType source = m_SourceIndices[s];
+      sum += spectrum[source] * (weight * gain(source));
+    }
+    bandPass[i] = sum;
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::AccumulateResponse(
+  const ComplexPixelType * response,
+  ComputePixelType *       amplitude,
+  ComputePixelType *       orientationEnergy,
+  SizeValueType            begin,
+  SizeValueType            end) const
+{
+  for (SizeValueType i = begin; i < end; ++i)
+  {
+    const ComputePixelType real = response[i].real();
+    const ComputePixelType imaginary = std::abs(response[i].imag());
+    amplitude[i] += std::abs(response[i]);
+    if (m_Polarity == 0)
+    {
+      orientationEnergy[i] += std::abs(real) - imaginary;
+    }
+    else if (m_Polarity == 1)
+    {
+      orientationEnergy[i] += real - imaginary;
+    }
+    else if (m_Polarity == -1)
+    {
+      orientationEnergy[i] += -real - imaginary;
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::AccumulateEnergy(
+  unsigned int             orientation,
+  const ComputePixelType * orientationEnergy,
+  ComputePixelType *       energy,
+  SizeValueType            begin,
+  SizeValueType            end) const
+{
+  const double threshold = m_NoiseThreshold * m_OrientationMultiplicities[orientation];
+  for (SizeValueType i = begin; i < end; ++i)
+  {
+    energy[i] += static_cast<ComputePixelType>(static_cast<double>(orientationEnergy[i]) - threshold);
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::AccumulateOrientation(
+  unsigned int             orientation,
+  const ComplexPixelType * spectrum,
+  ComputePixelType *       amplitude,
+  ComputePixelType *       energy,
+  ScratchType &            scratch) const
+{
+  ComplexPixelType * bandPass = scratch.BandPass.data();
+  ComputePixelType * orientationEnergy = scratch.OrientationEnergy.data();
+  std::fill(
+    scratch.OrientationEnergy.begin(), scratch.OrientationEnergy.end(), NumericTraits<ComputePixelType>::ZeroValue());
+
+  for (unsigned int w = 0; w < m_NumberOfScales; ++w)
+  {
+    this->BandPass(w, orientation, spectrum, bandPass, 0, m_NumberOfOutputPixels);
+    scratch.OutputTransform->transform(bandPass, -1);
+    this->AccumulateResponse(bandPass, amplitude, orientationEnergy, 0, m_NumberOfOutputPixels);
+  }
+  this->AccumulateEnergy(orientation, orientationEnergy, energy, 0, m_NumberOfOutputPixels);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::ComputeOutput(const ComputePixelType * amplitude,
+                                                                           const ComputePixelType * energy,
+                                                                           OutputPixelType *        output,
+                                                                           SizeValueType            begin,
+                                                                           SizeValueType            end) const
+{
+  for (SizeValueType i = begin; i < end; ++i)
+  {
+    if (amplitude[i] != NumericTraits<ComputePixelType>::ZeroValue())
+    {
+      const ComputePixelType energyValue = std::max(energy[i], NumericTraits<ComputePixelType>::ZeroValue());
+      output[i] = ConvertToOutputPixel(energyValue / amplitude[i]);
+    }
+    else
+    {
+      output[i] = NumericTraits<OutputPixelType>::max();
+    }
+  }
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::OutputPixelType
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::ConvertToOutputPixel(ComputePixelType value,
+                                                                                  std::false_type)
+{
+  return static_cast<OutputPixelType>(value);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+typename PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::OutputPixelType
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::ConvertToOutputPixel(ComputePixelType value,
+                                                                                  std::true_type)
+{
+  // The maximum of a 32 bit integer rounds up out of its range in float, and
+  // that of a 64 bit integer in double as well, so the rescaled value is
+  // computed in double and clamped to the maximum before the conversion. NaN
+  // converts to the maximum, as a zero amplitude does.
+  const double maximum = static_cast<double>(NumericTraits<OutputPixelType>::max());
+  const double scaled = std::min(std::max(static_cast<double>(value), 0.0), 1.0) * maximum + 0.5;
+  if (!(scaled < maximum))
+  {
+    return NumericTraits<OutputPixelType>::max();
+  }
+  return static_cast<OutputPixelType>(scaled);
+}
+
+
+template <typename TInputImage, typename TOutputImage, typename TComputePixel>
+void
+PhaseSymmetryPlan<TInputImage, TOutputImage, TComputePixel>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Size: " << m_Size << std::endl;
+  os << indent << "DecimationFactor: " << m_DecimationFactor << std::endl;
+  os << indent << "OutputSize: " << m_OutputSize << std::endl;
+  os << indent << "NumberOfScales: " << m_NumberOfScales << std::endl;
+  os << indent << "NumberOfDistinctOrientations: " << this->GetNumberOfDistinctOrientations() << std::endl;
+  os << indent << "Polarity: " << m_Polarity << std::endl;
+  os << indent << "NoiseThreshold: " << m_NoiseThreshold << std::endl;
+  os << indent << "HalfPrecisionFilterBank: " << !m_HalfFilterBank.empty() << std::endl;
+  os << indent << "FactorizedFilterBank: " << !m_ScaleFactors.empty() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,283 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetrySharedMemory_h
+#define itkPhaseSymmetrySharedMemory_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace itk
+{
+/** \class PhaseSymmetrySharedMemory
+ * \brief Named POSIX shared memory segment through which the local processes
+ * of a sharded PhaseSymmetryImageFilter job exchange data.
+ *
+ * The segment starts with a header of counters, which the processes update
+ * with lock-free atomic operations, followed by the data. One process
+ * creates the segment and publishes its header last; the others open it
+ * once it is published with the identifier of their run, and check that it
+ * was created for the same job. A segment that a failed run left under the
+ * same name carries another identifier, so the others wait for the creator
+ * to replace it instead of attaching to it.
+ * The name is removed as soon as every process has attached, or by its
+ * creator when the job fails before that, so that the segment is freed
+ * with the last mapping.
+ *
+ * Waits poll the counters and throw after the timeout, so that a process
+ * that never comes, or fails, does not block the others forever.
+ *
+ * \ingroup PhaseSymmetry
+ */
+class PhaseSymmetrySharedMemory
+{
+public:
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory counters must be lock-free");
+
+  using CounterType = std::atomic<unsigned int>;
+
+  /** Layout of the start of the segment. */
+  struct HeaderType
+  {
+    /** Set last by the creator, once the other fields are valid. */
+    CounterType  Magic;
+    unsigned int NumberOfProcesses;
+    uint64_t     Fingerprint;
+    uint64_t     RunIdentifier;
+    uint64_t     DataSizeInBytes;
+    CounterType  NumberOfAttachedProcesses;
+    CounterType  SpectrumReady;
+    CounterType  NextTicket;
+    CounterType  NumberOfReducedProcesses;
+  };
+
+  static constexpr unsigned int MagicValue = 0x50537368u;
+  /** Offset of the data, which keeps it aligned for any pixel type. */
+  static constexpr SizeValueType DataOffset = 128;
+  static_assert(sizeof(HeaderType) <= DataOffset, "The header must fit before the data");
+
+  PhaseSymmetrySharedMemory(const std::string & name, double timeout)
+    : m_Name(name)
+    , m_Timeout(timeout)
+  {}
+
+  ~PhaseSymmetrySharedMemory()
+  {
+#if !defined(_WIN32)
+    if (m_Created && m_Header && m_Header->NumberOfAttachedProcesses.load() < m_Header->NumberOfProcesses)
+    {
+      shm_unlink(m_Name.c_str());
+    }
+#endif
+    this->Unmap();
+  }
+
+  PhaseSymmetrySharedMemory(const PhaseSymmetrySharedMemory &) = delete;
+  PhaseSymmetrySharedMemory &
+  operator=(const PhaseSymmetrySharedMemory &) = delete;
+
+  /** Create the segment, replacing any segment a failed run left under the
+   * same name, and publish its header. */
+  void
+  Create(SizeValueType dataSizeInBytes, uint64_t fingerprint, uint64_t runIdentifier, unsigned int numberOfProcesses)
+  {
+#if defined(_WIN32)
+    (void)dataSizeInBytes;
+    (void)fingerprint;
+    (void)runIdentifier;
+    (void)numberOfProcesses;
+    itkGenericExceptionMacro(<< "Shared memory shards require POSIX shared memory");
+#else
+    shm_unlink(m_Name.c_str());
+    const int descriptor = shm_open(m_Name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (descriptor < 0)
+    {
+      itkGenericExceptionMacro(<< "Cannot create shared memory " << m_Name << ": " << std::strerror(errno));
+    }
+    m_Created = true;
+    const SizeValueType size = DataOffset + dataSizeInBytes;
+    if (ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+    {
+      const int error = errno;
+      close(descriptor);
+      shm_unlink(m_Name.c_str());
+      itkGenericExceptionMacro(<< "Cannot size shared memory " << m_Name << " to " << size
+                               << " bytes: " << std::strerror(error));
+    }
+    this->Map(descriptor, dataSizeInBytes);
+
+    // The segment is zero filled, which is the initial value of the counters
+    m_Header->NumberOfProcesses = numberOfProcesses;
+    m_Header->Fingerprint = fingerprint;
+    m_Header->RunIdentifier = runIdentifier;
+    m_Header->DataSizeInBytes = dataSizeInBytes;
+    m_Header->Magic.store(MagicValue, std::memory_order_release);
+    this->Attach();
+#endif
+  }
+
+  /** Open the segment once its creator has published it for this run, and
+   * check that it was created for the same job. */
+  void
+  Open(SizeValueType dataSizeInBytes, uint64_t fingerprint, uint64_t runIdentifier, unsigned int numberOfProcesses)
+  {
+#if defined(_WIN32)
+    (void)dataSizeInBytes;
+    (void)fingerprint;
+    (void)runIdentifier;
+    (void)numberOfProcesses;
+    itkGenericExceptionMacro(<< "Shared memory shards require POSIX shared memory");
+#else
+    const SizeValueType size = DataOffset + dataSizeInBytes;
+    const auto          start = std::chrono::steady_clock::now();
+    for (;;)
+    {
+      // The segment may not exist yet, not be sized or published yet, or be
+      // one that a failed run left and that the creator has yet to replace
+      const int   descriptor = shm_open(m_Name.c_str(), O_RDWR, 0);
+      struct stat status;
+      if (descriptor >= 0 && fstat(descriptor, &status) == 0 && static_cast<SizeValueType>(status.st_size) == size)
+      {
+        this->Map(descriptor, dataSizeInBytes);
+        if (m_Header->Magic.load(std::memory_order_acquire) == MagicValue && m_Header->RunIdentifier == runIdentifier)
+        {
+          break;
+        }
+        this->Unmap();
+      }
+      else if (descriptor >= 0)
+      {
+        close(descriptor);
+      }
+      this->CheckTimeout(start, "the shared memory of this run to be created");
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (m_Header->Fingerprint != fingerprint || m_Header->NumberOfProcesses != numberOfProcesses ||
+        m_Header->DataSizeInBytes != dataSizeInBytes)
+    {
+      itkGenericExceptionMacro(<< "Shared memory " << m_Name
+                               << " was created for another job, or with other input or parameters");
+    }
+    this->Attach();
+#endif
+  }
+
+  HeaderType *
+  GetHeader() const
+  {
+    return m_Header;
+  }
+
+  /** Get the data at an offset in bytes from its start. */
+  template <typename T>
+  T *
+  GetData(SizeValueType offset) const
+  {
+    return reinterpret_cast<T *>(reinterpret_cast<char *>(m_Header) + DataOffset + offset);
+  }
+
+  /** Wait until a counter reaches at least a value. */
+  void
+  WaitFor(const CounterType & counter, unsigned int value, const char * what) const
+  {
+    const auto start = std::chrono::steady_clock::now();
+    while (counter.load(std::memory_order_acquire) < value)
+    {
+      this->CheckTimeout(start, what);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+private:
+  void
+  Map(int descriptor, SizeValueType dataSizeInBytes)
+  {
+#if !defined(_WIN32)
+    void * address = mmap(nullptr, DataOffset + dataSizeInBytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    const int error = errno;
+    close(descriptor);
+    if (address == MAP_FAILED)
+    {
+      itkGenericExceptionMacro(<< "Cannot map shared memory " << m_Name << ": " << std::strerror(error));
+    }
+    m_Header = static_cast<HeaderType *>(address);
+    m_DataSizeInBytes = dataSizeInBytes;
+#else
+    (void)descriptor;
+    (void)dataSizeInBytes;
+#endif
+  }
+
+  void
+  Unmap()
+  {
+#if !defined(_WIN32)
+    if (m_Header)
+    {
+      munmap(m_Header, DataOffset + m_DataSizeInBytes);
+      m_Header = nullptr;
+    }
+#endif
+  }
+
+  /** Count this process as attached; the last one removes the name. */
+  void
+  Attach()
+  {
+#if !defined(_WIN32)
+    if (m_Header->NumberOfAttachedProcesses.fetch_add(1) + 1 == m_Header->NumberOfProcesses)
+    {
+      shm_unlink(m_Name.c_str());
+    }
+#endif
+  }
+
+  void
+  CheckTimeout(std::chrono::steady_clock::time_point start, const char * what) const
+  {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() > m_Timeout)
+    {
+      itkGenericExceptionMacro(<< "Timed out after " << m_Timeout << " s waiting for " << what << " in shared memory "
+                               << m_Name);
+    }
+  }
+
+  std::string   m_Name;
+  double        m_Timeout;
+  HeaderType *  m_Header{ nullptr };
+  SizeValueType m_DataSizeInBytes{ 0 };
+  bool          m_Created{ false };
+};
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryWorkloadImageSource_h
+#define itkPhaseSymmetryWorkloadImageSource_h
+
+#include "itkGenerateImageSource.h"
+#include "itkSinusoidSpatialFunction.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class PhaseSymmetryWorkloadImageSource
+ * \brief Generate a reproducible synthetic input of any size for load tests
+ * of the phase symmetry filter.
+ *
+ * The image is the mean of NumberOfSinusoids sinusoids of random
+ * orientations, frequencies and phases, plus NumberOfSurfaces bright
+ * spherical shells of random centers and radii, which stand for curved
+ * bone surfaces, all multiplied by speckle-like Rayleigh noise of mean one:
+ *
+ * \f[
+ *   I(\mathbf{x}) = \left(\frac{1}{K}\sum_k \cos(2\pi\omega_k \cdot \mathbf{x} + \phi_k)
+ *     + A\sum_s e^{-(|\mathbf{x} - \mathbf{c}_s| - r_s)^2 / 2t^2}\right)
+ *     \left(1 - \lambda + \lambda n(\mathbf{x})\right)
+ * \f]
+ *
+ * The components are drawn from Seed when the output is generated, by a
+ * random engine whose sequence is standardized, so that the image is the
+ * same on every platform. The noise of a pixel is a hash of the seed and of
+ * the pixel index. A pixel therefore does not depend on the requested
+ * region or on the threads, and the source streams: with a writer that
+ * streams, such as ImageFileWriter with SetNumberOfStreamDivisions() and a
+ * MetaImage file, volumes far larger than the memory are written piece by
+ * piece.
+ *
+ * The sinusoids are evaluated by scanlines with
+ * SinusoidSpatialFunction::EvaluateLine().
+ *
+ * \sa SinusoidImageSource
+ *
+ * \ingroup PhaseSymmetry
+ */
+template <typename TOutputImage>
+class PhaseSymmetryWorkloadImageSource : public GenerateImageSource<TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PhaseSymmetryWorkloadImageSource);
+
+  /** Standard class type alias. */
+  using Self = PhaseSymmetryWorkloadImageSource;
+  using Superclass = GenerateImageSource<TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Dimensionality of the output image */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  using OutputImageType = TOutputImage;
+  using OutputImagePixelType = typename TOutputImage::PixelType;
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using PointType = typename Superclass::PointType;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PhaseSymmetryWorkloadImageSource, GenerateImageSource);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Set/Get the seed of the components and of the noise. */
+  itkSetMacro(Seed, uint64_t);
+  itkGetConstMacro(Seed, uint64_t);
+
+  /** Set/Get the number of sinusoids. */
+  itkSetMacro(NumberOfSinusoids, unsigned int);
+  itkGetConstMacro(NumberOfSinusoids, unsigned int);
+
+  /** Set/Get the range of the frequencies of the sinusoids, in cycles per
+   * spatial unit. */
+  itkSetMacro(MinimumFrequency, double);
+  itkGetConstMacro(MinimumFrequency, double);
+  itkSetMacro(MaximumFrequency, double);
+  itkGetConstMacro(MaximumFrequency, double);
+
+  /** Set/Get the number of bright surfaces. */
+  itkSetMacro(NumberOfSurfaces, unsigned int);
+  itkGetConstMacro(NumberOfSurfaces, unsigned int);
+
+  /** Set/Get the peak intensity of the surfaces. */
+  itkSetMacro(SurfaceIntensity, double);
+  itkGetConstMacro(SurfaceIntensity, double);
+
+  /** Set/Get the thickness of the surfaces, the standard deviation of their
+   * profile across, in spatial units. */
+  itkSetMacro(SurfaceThickness, double);
+  itkGetConstMacro(SurfaceThickness, double);
+
+  /** Set/Get the weight of the speckle noise, from 0, no noise, to 1, a
+   * fully multiplicative noise. */
+  itkSetClampMacro(SpeckleLevel, double, 0.0, 1.0);
+  itkGetConstMacro(SpeckleLevel, double);
+
+protected:
+  PhaseSymmetryWorkloadImageSource() = default;
+  ~PhaseSymmetryWorkloadImageSource() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  /** Uniform value in (0, 1] of the noise of a pixel. */
+  static double
+  HashToUniform(uint64_t seed, uint64_t pixel);
+
+private:
+  using FunctionType = SinusoidSpatialFunction<double, ImageDimension>;
+
+  uint64_t     m_Seed{ 0 };
+  unsigned int m_NumberOfSinusoids{ 16 };
+  double       m_MinimumFrequency{ 0.01 };
+  double       m_MaximumFrequency{ 0.2 };
+  unsigned int m_NumberOfSurfaces{ 4 };
+  double       m_SurfaceIntensity{ 2.0 };
+  double       m_SurfaceThickness{ 2.0 };
+  double       m_SpeckleLevel{ 0.5 };
+
+  // Components drawn in BeforeThreadedGenerateData()
+  std::vector<typename FunctionType::Pointer> m_Sinusoids;
+  std::vector<PointType>                      m_SurfaceCenters;
+  std::vector<double>                         m_SurfaceRadii;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkPhaseSymmetryWorkloadImageSource.hxx"
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryWorkloadImageSource_hxx
+#define itkPhaseSymmetryWorkloadImageSource_hxx
+
+#include "itkPhaseSymmetryWorkloadImageSource.h"
+#include "itkImageScanlineIterator.h"
+#include "itkMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace itk
+{
+
+template <typename TOutputImage>
+void
+PhaseSymmetryWorkloadImageSource<TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Seed: " << m_Seed << std::endl;
+  os << indent << "NumberOfSinusoids: " << m_NumberOfSinusoids << std::endl;
+  os << indent << "MinimumFrequency: " << m_MinimumFrequency << std::endl;
+  os << indent << "MaximumFrequency: " << m_MaximumFrequency << std::endl;
+  os << indent << "NumberOfSurfaces: " << m_NumberOfSurfaces << std::endl;
+  os << indent << "SurfaceIntensity: " << m_SurfaceIntensity << std::endl;
+  os << indent << "SurfaceThickness: " << m_SurfaceThickness << std::endl;
+  os << indent << "SpeckleLevel: " << m_SpeckleLevel << std::endl;
+}
+
+
+template <typename TOutputImage>
+double
+PhaseSymmetryWorkloadImageSource<TOutputImage>::HashToUniform(uint64_t seed, uint64_t pixel)
+{
+  // SplitMix64 finalizer of the seed and the pixel
+  const auto mix = [](uint64_t value) {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+  };
+  const uint64_t hash = mix(mix(seed) ^ pixel);
+  return double((hash >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryWorkloadImageSource<TOutputImage>::BeforeThreadedGenerateData()
+{
+  if (m_MinimumFrequency > m_MaximumFrequency)
+  {
+    itkExceptionMacro(<< "The minimum frequency " << m_MinimumFrequency << " exceeds the maximum frequency "
+                      << m_MaximumFrequency);
+  }
+
+  // The sequence of std::mt19937_64 is standardized, unlike those of the
+  // standard distributions, so the values are drawn from its raw output
+  std::mt19937_64 engine(m_Seed);
+  const auto      uniform = [&engine]() { return double(engine() >> 11) * (1.0 / 9007199254740992.0); };
+  const auto      normal = [&uniform]() {
+    const double radius = std::sqrt(-2.0 * std::log(1.0 - uniform()));
+    return radius * std::cos(2.0 * itk::Math::pi * uniform());
+  };
+
+  m_Sinusoids.clear();
+  for (unsigned int kk = 0; kk < m_NumberOfSinusoids; ++kk)
+  {
+    typename FunctionType::ArrayType direction;
+    double                           norm = 0.0;
+    while (norm == 0.0)
+    {
+      for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+      {
+        direction[dd] = normal();
+        norm += direction[dd] * direction[dd];
+      }
+    }
+    const double frequency = m_MinimumFrequency + (m_MaximumFrequency - m_MinimumFrequency) * uniform();
+    for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+    {
+      direction[dd] *= frequency / std::sqrt(norm);
+    }
+
+    typename FunctionType::Pointer sinusoid = FunctionType::New();
+    sinusoid->SetFrequency(direction);
+    sinusoid->SetPhaseOffset(2.0 * itk::Math::pi * uniform());
+    m_Sinusoids.push_back(sinusoid);
+  }
+
+  // Surfaces centered inside the image, with radii from a quarter to a half
+  // of its diagonal
+  const OutputImageType *     output = this->GetOutput();
+  const OutputImageRegionType largestRegion = output->GetLargestPossibleRegion();
+  PointType                   firstCorner;
+  PointType                   lastCorner;
+  output->TransformIndexToPhysicalPoint(largestRegion.GetIndex(), firstCorner);
+  output->TransformIndexToPhysicalPoint(largestRegion.GetUpperIndex(), lastCorner);
+  const double diagonal = firstCorner.EuclideanDistanceTo(lastCorner);
+
+  m_SurfaceCenters.clear();
+  m_SurfaceRadii.clear();
+  for (unsigned int ss = 0; ss < m_NumberOfSurfaces; ++ss)
+  {
+    ContinuousIndex<double, ImageDimension> centerIndex;
+    for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+    {
+      centerIndex[dd] = largestRegion.GetIndex(dd) + uniform() * (largestRegion.GetSize(dd) - 1);
+    }
+    PointType center;
+    output->TransformContinuousIndexToPhysicalPoint(centerIndex, center);
+    m_SurfaceCenters.push_back(center);
+    m_SurfaceRadii.push_back(diagonal * (0.25 + 0.25 * uniform()));
+  }
+}
+
+
+template <typename TOutputImage>
+void
+PhaseSymmetryWorkloadImageSource<TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  using IndexType = typename OutputImageType::IndexType;
+
+  OutputImageType *           output = this->GetOutput();
+  const OutputImageRegionType largestRegion = output->GetLargestPossibleRegion();
+
+  // Physical step between neighbors along the scanline axis
+  IndexType index = largestRegion.GetIndex();
+  PointType first;
+  PointType next;
+  output->TransformIndexToPhysicalPoint(index, first);
+  index[0] += 1;
+  output->TransformIndexToPhysicalPoint(index, next);
+  const typename FunctionType::VectorType step = next - first;
+  const double                            squaredStep = step.GetSquaredNorm();
+
+  const double sinusoidWeight = m_Sinusoids.empty() ? 0.0 : 1.0 / double(m_Sinusoids.size());
+  const double surfaceExponentScale = -1.0 / (2.0 * m_SurfaceThickness * m_SurfaceThickness);
+  const double inverseRayleighMean = 1.0 / std::sqrt(itk::Math::pi / 2.0);
+
+  const SizeValueType lineLength = outputRegionForThread.GetSize(0);
+  std::vector<double> lineValues(lineLength);
+  std::vector<double> sinusoidValues(lineLength);
+
+  ImageScanlineIterator<OutputImageType> outIt(output, outputRegionForThread);
+  while (!outIt.IsAtEnd())
+  {
+    index = outIt.GetIndex();
+    PointType start;
+    output->TransformIndexToPhysicalPoint(index, start);
+
+    std::fill(lineValues.begin(), lineValues.end(), 0.0);
+    for (const auto & sinusoid : m_Sinusoids)
+    {
+      sinusoid->EvaluateLine(start, step, sinusoidValues.data(), lineLength);
+      for (SizeValueType xx = 0; xx < lineLength; ++xx)
+      {
+        lineValues[xx] += sinusoidWeight * sinusoidValues[xx];
+      }
+    }
+
+    // |start + x step - center|^2 is a quadratic in x
+    for (std::size_t ss = 0; ss < m_SurfaceCenters.size(); ++ss)
+    {
+      const typename FunctionType::VectorType offset = start - m_SurfaceCenters[ss];
+      const double                            squaredOffset = offset.GetSquaredNorm();
+      const double                            dotProduct = offset * step;
+      const double                            radius = m_SurfaceRadii[ss];
+      for (SizeValueType xx = 0; xx < lineLength; ++xx)
+      {
+        const double x = double(xx);
+        const double distance = std::sqrt(std::max(0.0, squaredOffset + x * (2.0 * dotProduct + x * squaredStep)));
+        const double across = distance - radius;
+        lineValues[xx] += m_SurfaceIntensity * std::exp(across * across * surfaceExponentScale);
+      }
+    }
+
+    // Speckle, from the index of the pixel in the largest possible region
+    uint64_t      pixel = 0;
+    SizeValueType stride = 1;
+    for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+    {
+      pixel += uint64_t(index[dd] - largestRegion.GetIndex(dd)) * stride;
+      stride *= largestRegion.GetSize(dd);
+    }
+    OutputImagePixelType * out = &outIt.Value();
+    for (SizeValueType xx = 0; xx < lineLength; ++xx)
+    {
+      const double rayleigh = std::sqrt(-2.0 * std::log(HashToUniform(m_Seed, pixel + xx))) * inverseRayleighMean;
+      const double speckle = 1.0 - m_SpeckleLevel + m_SpeckleLevel * rayleigh;
+      out[xx] = static_cast<OutputImagePixelType>(lineValues[xx] * speckle);
+    }
+    outIt.NextLine();
+  }
+}
+
+} // end namespace itk
+
+#endif
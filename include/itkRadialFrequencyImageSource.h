@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRadialFrequencyImageSource_h
+#define itkRadialFrequencyImageSource_h
+
+#include "itkGenerateImageSource.h"
+
+namespace itk
+{
+
+/** \class RadialFrequencyImageSource
+ * \brief Base class of frequency domain kernels that depend on a weighted
+ * frequency radius only.
+ *
+ * The frequency of index i along an axis is (size / 2 - i) / size, weighted
+ * by GetRadiusScales(). Subclasses evaluate their profile over a scanline of
+ * squared radii in EvaluateRadialProfile().
+ *
+ * The squared radius at index i is the same as at size - i along every axis.
+ * When the whole image is requested, the profile is evaluated over the
+ * indices 0 to size / 2 of every axis only, and mirrored into the rest of the
+ * image, which divides the profile evaluations by about 2^ImageDimension.
+ * Smaller requested regions are generated directly.
+ *
+ * \ingroup PhaseSymmetry
+ */
+template <typename TOutputImage>
+class RadialFrequencyImageSource : public GenerateImageSource<TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(RadialFrequencyImageSource);
+
+  /** Standard class type alias. */
+  using Self = RadialFrequencyImageSource;
+  using Superclass = GenerateImageSource<TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Dimensionality of the output image */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  using OutputImageType = TOutputImage;
+  using OutputImagePixelType = typename TOutputImage::PixelType;
+  using OutputImageRegionType = typename TOutputImage::RegionType;
+  using SizeType = typename TOutputImage::SizeType;
+
+  using ArrayType = FixedArray<double, ImageDimension>;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RadialFrequencyImageSource, GenerateImageSource);
+
+protected:
+  RadialFrequencyImageSource() = default;
+  ~RadialFrequencyImageSource() override = default;
+
+  /** Weight of the frequency along each axis in the radius. */
+  virtual ArrayType
+  GetRadiusScales() const = 0;
+
+  /** Evaluate the profile at count squared radii. */
+  virtual void
+  EvaluateRadialProfile(const double * squaredRadii, OutputImagePixelType * values, SizeValueType count) const = 0;
+
+  void
+  GenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  /** Generate a region of the output. With mirror, also write the pixels
+   * that mirror those of the region about the center of every axis. */
+  void
+  GenerateRadialRegion(const OutputImageRegionType & region, bool mirror);
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkRadialFrequencyImageSource.hxx"
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRadialFrequencyImageSource_hxx
+#define itkRadialFrequencyImageSource_hxx
+
+#include "itkRadialFrequencyImageSource.h"
+#include "itkImageScanlineIterator.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+
+template <typename TOutputImage>
+void
+RadialFrequencyImageSource<TOutputImage>::GenerateData()
+{
+  OutputImageType *           output = this->GetOutput();
+  const OutputImageRegionType largestRegion = output->GetLargestPossibleRegion();
+  bool                        mirror = output->GetRequestedRegion() == largestRegion;
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    // The symmetry is about size / 2 of the index, not of the offset from the
+    // start index
+    mirror = mirror && largestRegion.GetIndex(ii) == 0;
+  }
+  if (!mirror)
+  {
+    Superclass::GenerateData();
+    return;
+  }
+
+  this->AllocateOutputs();
+
+  // Indices 0 to size / 2 along every axis represent all the others
+  OutputImageRegionType orthant = largestRegion;
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    orthant.SetSize(ii, largestRegion.GetSize(ii) / 2 + 1);
+  }
+
+  // The mirror images of distinct pixels are distinct, so that the work units
+  // write disjoint pixels
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+    orthant, [this](const OutputImageRegionType & region) { this->GenerateRadialRegion(region, true); }, this);
+}
+
+
+template <typename TOutputImage>
+void
+RadialFrequencyImageSource<TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  this->GenerateRadialRegion(outputRegionForThread, false);
+}
+
+
+template <typename TOutputImage>
+void
+RadialFrequencyImageSource<TOutputImage>::GenerateRadialRegion(const OutputImageRegionType & region, bool mirror)
+{
+  using IndexType = typename OutputImageType::IndexType;
+
+  OutputImageType * outputPtr = this->GetOutput();
+  const SizeType    size = outputPtr->GetLargestPossibleRegion().GetSize();
+
+  // The weighted frequency of index i along an axis is
+  // (center - i) * radiusScale / size
+  const ArrayType radiusScales = this->GetRadiusScales();
+  ArrayType       centerPoint;
+  ArrayType       scale;
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    centerPoint[ii] = double(size[ii]) / 2.0;
+    scale[ii] = radiusScales[ii] / double(size[ii]);
+  }
+
+  const SizeValueType               lineLength = region.GetSize(0);
+  std::vector<double>               squaredRadii(lineLength);
+  std::vector<OutputImagePixelType> values(lineLength);
+  std::vector<IndexType>            mirrorLines;
+  mirrorLines.reserve(SizeValueType(1) << (ImageDimension - 1));
+
+  ImageScanlineIterator<OutputImageType> outIt(outputPtr, region);
+  while (!outIt.IsAtEnd())
+  {
+    const IndexType index = outIt.GetIndex();
+
+    // Squared radius of the axes other than the scanline axis
+    double lineRadius = 0.0;
+    for (unsigned int ii = 1; ii < ImageDimension; ++ii)
+    {
+      const double dist = (centerPoint[ii] - double(index[ii])) * scale[ii];
+      lineRadius += dist * dist;
+    }
+    const double lineStart = centerPoint[0] - double(index[0]);
+    for (SizeValueType xx = 0; xx < lineLength; ++xx)
+    {
+      const double dist = (lineStart - double(xx)) * scale[0];
+      squaredRadii[xx] = lineRadius + dist * dist;
+    }
+
+    this->EvaluateRadialProfile(squaredRadii.data(), values.data(), lineLength);
+
+    if (!mirror)
+    {
+      std::copy(values.begin(), values.end(), &outIt.Value());
+      outIt.NextLine();
+      continue;
+    }
+
+    // The line and its mirror images about the center of the other axes
+    mirrorLines.assign(1, index);
+    for (unsigned int ii = 1; ii < ImageDimension; ++ii)
+    {
+      const IndexValueType mirrored = static_cast<IndexValueType>(size[ii]) - index[ii];
+      if (index[ii] > 0 && mirrored != index[ii])
+      {
+        const std::size_t numberOfLines = mirrorLines.size();
+        for (std::size_t ll = 0; ll < numberOfLines; ++ll)
+        {
+          IndexType mirrorLine = mirrorLines[ll];
+          mirrorLine[ii] = mirrored;
+          mirrorLines.push_back(mirrorLine);
+        }
+      }
+    }
+
+    const auto lineSize = static_cast<IndexValueType>(size[0]);
+    for (IndexType mirrorLine : mirrorLines)
+    {
+      mirrorLine[0] = 0;
+      OutputImagePixelType * out = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset(mirrorLine);
+      for (SizeValueType xx = 0; xx < lineLength; ++xx)
+      {
+        const IndexValueType x = index[0] + static_cast<IndexValueType>(xx);
+        out[x] = values[xx];
+        if (x > 0 && lineSize - x != x)
+        {
+          out[lineSize - x] = values[xx];
+        }
+      }
+    }
+    outIt.NextLine();
+  }
+}
+
+} // end namespace itk
+
+#endif
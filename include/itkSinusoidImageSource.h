@@ -21,6 +21,9 @@
 #include "itkParametricImageSource.h"
 #include "itkFixedArray.h"
 
+#include <complex>
+#include <vector>
+
 namespace itk
 {
 
@@ -34,6 +37,20 @@ namespace itk
  * where \f$\omega_i\f$ is the frequency, in spatial units, in direction
  * \f$i\f$, and \f$\phi\f$ is a phase shift.
  *
+ * The output is generated by scanlines, in parallel, over the requested
+ * region only, so that it can be streamed. Each scanline is evaluated by
+ * SinusoidSpatialFunction::EvaluateLine(), which advances the cosine by the
+ * angle addition formulas rather than evaluating it per pixel.
+ *
+ * With GenerateSpectrum on, a second output holds the discrete Fourier
+ * transform of the first, the output of ForwardFFTImageFilter over the
+ * largest possible region, in closed form. Along each axis, the samples of
+ * the complex exponentials of the cosine form a geometric series, so that
+ * the spectrum is a product of Dirichlet kernels: two spikes when the
+ * frequency falls on a bin of every axis, and their leakage otherwise. The
+ * frequency index is relative to the start index of the largest possible
+ * region, as for the FFT filters.
+ *
  * \ingroup DataSources
  * \ingroup PhaseSymmetry
  */
@@ -58,6 +75,10 @@ public:
   /** Type used to store Sinusoid parameters. */
   using ArrayType = FixedArray<double, ImageDimension>;
 
+  /** Complex image of the spectrum output. */
+  using SpectrumPixelType = std::complex<typename TOutputImage::PixelType>;
+  using SpectrumImageType = Image<SpectrumPixelType, ImageDimension>;
+
   /** Size type matches that used for images */
   using SizeType = typename TOutputImage::SizeType;
   using SizeValueType = typename TOutputImage::SizeValueType;
@@ -79,6 +100,16 @@ public:
   itkSetMacro(Frequency, ArrayType);
   itkGetConstReferenceMacro(Frequency, ArrayType);
 
+  /** Set/Get whether the spectrum output is generated. */
+  virtual void
+  SetGenerateSpectrum(bool generateSpectrum);
+  itkGetConstMacro(GenerateSpectrum, bool);
+  itkBooleanMacro(GenerateSpectrum);
+
+  /** Get the spectrum output, with GenerateSpectrum on. */
+  SpectrumImageType *
+  GetSpectrumOutput();
+
   /** Set/get the parameters for this source. When this source is
    * templated over an N-dimensional output image type, the first N
    * values in the parameter array are the Frequency parameters in each
@@ -100,8 +131,23 @@ protected:
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
+  using Superclass::MakeOutput;
+  ProcessObject::DataObjectPointer
+  MakeOutput(ProcessObject::DataObjectPointerArraySizeType idx) override;
+
   void
-  GenerateData() override;
+  GenerateOutputInformation() override;
+
+  void
+  DynamicThreadedGenerateData(const typename OutputImageType::RegionType & outputRegionForThread) override;
+
+  /** Generate the spectrum output. */
+  void
+  AfterThreadedGenerateData() override;
+
+  /** Sum of exp(2 pi i binOffset n / length) over n from 0 to length - 1. */
+  static std::complex<double>
+  GeometricSum(double binOffset, SizeValueType length);
 
 private:
   /** Parameters for the Sinusoid. */
@@ -112,6 +158,8 @@ private:
   /** The phase shift. */
   double m_PhaseOffset{ 0.0 };
 
+  bool m_GenerateSpectrum{ false };
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Really only want to use a floating point pixel because the domain of the
    * output will be [-1, 1] */
@@ -20,8 +20,10 @@
 
 #include "itkSinusoidImageSource.h"
 #include "itkSinusoidSpatialFunction.h"
-#include "itkImageRegionIterator.h"
-#include "itkProgressReporter.h"
+#include "itkImageScanlineIterator.h"
+#include "itkMath.h"
+
+#include <cmath>
 
 namespace itk
 {
@@ -52,6 +54,52 @@ SinusoidImageSource<TOutputImage>::PrintSelf(std::ostream & os, Indent indent) c
   os << "]" << std::endl;
 
   os << indent << "Sinusoid phase shift: " << m_PhaseOffset << std::endl;
+  os << indent << "GenerateSpectrum: " << m_GenerateSpectrum << std::endl;
+}
+
+
+template <typename TOutputImage>
+void
+SinusoidImageSource<TOutputImage>::SetGenerateSpectrum(bool generateSpectrum)
+{
+  if (m_GenerateSpectrum == generateSpectrum)
+  {
+    return;
+  }
+  m_GenerateSpectrum = generateSpectrum;
+
+  const unsigned int numberOfOutputs = generateSpectrum ? 2 : 1;
+  this->SetNumberOfRequiredOutputs(numberOfOutputs);
+  this->SetNumberOfIndexedOutputs(numberOfOutputs);
+  if (generateSpectrum && !this->ProcessObject::GetOutput(1))
+  {
+    this->SetNthOutput(1, this->MakeOutput(1));
+  }
+  this->Modified();
+}
+
+
+template <typename TOutputImage>
+typename SinusoidImageSource<TOutputImage>::SpectrumImageType *
+SinusoidImageSource<TOutputImage>::GetSpectrumOutput()
+{
+  if (!m_GenerateSpectrum)
+  {
+    itkExceptionMacro(<< "No spectrum output with GenerateSpectrum off");
+  }
+  return static_cast<SpectrumImageType *>(this->ProcessObject::GetOutput(1));
+}
+
+
+template <typename TOutputImage>
+ProcessObject::DataObjectPointer
+SinusoidImageSource<TOutputImage>::MakeOutput(ProcessObject::DataObjectPointerArraySizeType idx)
+{
+  if (idx == 1)
+  {
+    return SpectrumImageType::New().GetPointer();
+  }
+  return Superclass::MakeOutput(idx);
 }
 
 
@@ -96,43 +144,156 @@ SinusoidImageSource<TOutputImage>::GetNumberOfParameters() const
 
 template <typename TOutputImage>
 void
-SinusoidImageSource<TOutputImage>::GenerateData()
+SinusoidImageSource<TOutputImage>::GenerateOutputInformation()
 {
-  TOutputImage * outputPtr = this->GetOutput();
+  Superclass::GenerateOutputInformation();
+
+  if (m_GenerateSpectrum)
+  {
+    this->GetSpectrumOutput()->CopyInformation(this->GetOutput());
+  }
+}
 
-  // allocate the output buffer
-  outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
-  outputPtr->Allocate();
 
-  // Create and initialize a new gaussian function
+template <typename TOutputImage>
+void
+SinusoidImageSource<TOutputImage>::DynamicThreadedGenerateData(
+  const typename OutputImageType::RegionType & outputRegionForThread)
+{
   using FunctionType = SinusoidSpatialFunction<double, ImageDimension>;
-  typename FunctionType::Pointer sinusoid = FunctionType::New();
+  using PointType = typename FunctionType::InputType;
+
+  TOutputImage * outputPtr = this->GetOutput();
 
+  typename FunctionType::Pointer sinusoid = FunctionType::New();
   sinusoid->SetFrequency(m_Frequency);
   sinusoid->SetPhaseOffset(m_PhaseOffset);
 
-  // Create an iterator that will walk the output region
-  using OutputIterator = ImageRegionIterator<TOutputImage>;
-  const typename OutputImageType::RegionType requestedRegion = outputPtr->GetRequestedRegion();
-  OutputIterator                             outIt = OutputIterator(outputPtr, outputPtr->GetRequestedRegion());
+  // Physical step between neighbors along the scanline axis
+  typename TOutputImage::IndexType index;
+  index.Fill(0);
+  PointType origin;
+  PointType next;
+  outputPtr->TransformIndexToPhysicalPoint(index, origin);
+  index[0] = 1;
+  outputPtr->TransformIndexToPhysicalPoint(index, next);
+  const typename FunctionType::VectorType step = next - origin;
 
-  ProgressReporter progress(this, 0, outputPtr->GetRequestedRegion().GetNumberOfPixels());
-  // Walk the output image, evaluating the spatial function at each pixel
-  outIt.GoToBegin();
+  const SizeValueType                 lineLength = outputRegionForThread.GetSize(0);
+  ImageScanlineIterator<TOutputImage> outIt(outputPtr, outputRegionForThread);
   while (!outIt.IsAtEnd())
   {
-    typename TOutputImage::IndexType index = outIt.GetIndex();
-    // The position at which the function is evaluated
-    typename FunctionType::InputType evalPoint;
-    outputPtr->TransformIndexToPhysicalPoint(index, evalPoint);
-    const double value = sinusoid->Evaluate(evalPoint);
+    PointType start;
+    outputPtr->TransformIndexToPhysicalPoint(outIt.GetIndex(), start);
+    sinusoid->EvaluateLine(start, step, &outIt.Value(), lineLength);
+    outIt.NextLine();
+  }
+}
 
-    // Set the pixel value to the function value
-    outIt.Set(static_cast<typename TOutputImage::PixelType>(value));
-    progress.CompletedPixel();
 
-    ++outIt;
+template <typename TOutputImage>
+std::complex<double>
+SinusoidImageSource<TOutputImage>::GeometricSum(double binOffset, SizeValueType length)
+{
+  // The ratio of the series is one when the offset is a multiple of the
+  // length, and otherwise the numerator vanishes for whole bin offsets
+  const double wraps = binOffset / double(length);
+  if (wraps == std::round(wraps))
+  {
+    return std::complex<double>(double(length), 0.0);
+  }
+  const double               fraction = binOffset - std::round(binOffset);
+  const std::complex<double> one(1.0, 0.0);
+  return (one - std::polar(1.0, 2.0 * itk::Math::pi * fraction)) / (one - std::polar(1.0, 2.0 * itk::Math::pi * wraps));
+}
+
+
+template <typename TOutputImage>
+void
+SinusoidImageSource<TOutputImage>::AfterThreadedGenerateData()
+{
+  if (!m_GenerateSpectrum)
+  {
+    return;
   }
+
+  using IndexType = typename TOutputImage::IndexType;
+  using PointType = typename TOutputImage::PointType;
+  using RegionType = typename TOutputImage::RegionType;
+
+  const TOutputImage * outputPtr = this->GetOutput();
+  SpectrumImageType *  spectrum = this->GetSpectrumOutput();
+  const RegionType     largestRegion = outputPtr->GetLargestPossibleRegion();
+  const IndexType      startIndex = largestRegion.GetIndex();
+
+  // With n the index from the start, the phase of the cosine is
+  // startPhase + 2 pi sum_d cycles_d n_d, so that the transform of each of
+  // its two exponentials is a product of geometric sums, one per axis
+  PointType start;
+  outputPtr->TransformIndexToPhysicalPoint(startIndex, start);
+  double startPhase = m_PhaseOffset;
+  for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+  {
+    startPhase += 2.0 * itk::Math::pi * m_Frequency[ii] * start[ii];
+  }
+  const std::complex<double> halfPositive = std::polar(0.5, startPhase);
+  const std::complex<double> halfNegative = std::conj(halfPositive);
+
+  std::vector<std::complex<double>> positiveSums[ImageDimension];
+  std::vector<std::complex<double>> negativeSums[ImageDimension];
+  for (unsigned int dd = 0; dd < ImageDimension; ++dd)
+  {
+    IndexType nextIndex = startIndex;
+    nextIndex[dd] += 1;
+    PointType next;
+    outputPtr->TransformIndexToPhysicalPoint(nextIndex, next);
+    double cycles = 0.0;
+    for (unsigned int ii = 0; ii < ImageDimension; ++ii)
+    {
+      cycles += m_Frequency[ii] * (next[ii] - start[ii]);
+    }
+
+    const SizeValueType length = largestRegion.GetSize(dd);
+    const double        bins = cycles * double(length);
+    positiveSums[dd].resize(length);
+    negativeSums[dd].resize(length);
+    for (SizeValueType kk = 0; kk < length; ++kk)
+    {
+      positiveSums[dd][kk] = GeometricSum(bins - double(kk), length);
+      negativeSums[dd][kk] = GeometricSum(-bins - double(kk), length);
+    }
+  }
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+    spectrum->GetRequestedRegion(),
+    [&](const RegionType & region) {
+      const SizeValueType                      lineLength = region.GetSize(0);
+      ImageScanlineIterator<SpectrumImageType> outIt(spectrum, region);
+      while (!outIt.IsAtEnd())
+      {
+        const IndexType      index = outIt.GetIndex();
+        std::complex<double> linePositive = halfPositive;
+        std::complex<double> lineNegative = halfNegative;
+        for (unsigned int dd = 1; dd < ImageDimension; ++dd)
+        {
+          const SizeValueType kk = index[dd] - startIndex[dd];
+          linePositive *= positiveSums[dd][kk];
+          lineNegative *= negativeSums[dd][kk];
+        }
+
+        const SizeValueType first = index[0] - startIndex[0];
+        SpectrumPixelType * out = &outIt.Value();
+        for (SizeValueType xx = 0; xx < lineLength; ++xx)
+        {
+          const std::complex<double> value =
+            linePositive * positiveSums[0][first + xx] + lineNegative * negativeSums[0][first + xx];
+          out[xx] = static_cast<SpectrumPixelType>(value);
+        }
+        outIt.NextLine();
+      }
+    },
+    nullptr);
 }
 
 } // end namespace itk
@@ -21,6 +21,9 @@
 #include "itkSpatialFunction.h"
 #include "itkFixedArray.h"
 #include "itkFloatTypes.h"
+#include "itkMatrix.h"
+#include "itkSize.h"
+#include "itkVector.h"
 
 
 namespace itk
@@ -35,6 +38,12 @@ namespace itk
  * where \f$\omega_i\f$ is the frequency, in spatial units, in direction
  * \f$i\f$, and \f$\phi\f$ is a phase shift.
  *
+ * Besides the per point Evaluate() of the SpatialFunction interface, the
+ * function evaluates arrays of points, lines of evenly spaced points and
+ * regular grids in one non-virtual call. Along a line the phase grows by a
+ * constant step, and the cosine is advanced by the angle addition formulas,
+ * evaluated directly every few points to bound the rounding error.
+ *
  * \sa SinusoidImageSource
  *
  * \ingroup SpatialFunctions
@@ -70,10 +79,38 @@ public:
   /** Type used to store gaussian parameters. */
   using ArrayType = FixedArray<double, VImageDimension>;
 
+  /** Type of the step between the points of a line. */
+  using VectorType = Vector<double, VImageDimension>;
+
+  /** Type of the steps of a grid, one column per grid axis. */
+  using MatrixType = Matrix<double, VImageDimension, VImageDimension>;
+
+  /** Type of the size of a grid. */
+  using SizeType = Size<VImageDimension>;
+
   /** Evaluate the function at a given position. */
   OutputType
   Evaluate(const TInput & position) const override;
 
+  /** Evaluate the function at count contiguous positions. The phases are
+   * computed first, so that the loop of cosines has no dependency and can
+   * use the vector math of the compiler. */
+  template <typename TValue>
+  void
+  Evaluate(const TInput * positions, TValue * values, SizeValueType count) const;
+
+  /** Evaluate the function at count points start + i * step. */
+  template <typename TValue>
+  void
+  EvaluateLine(const TInput & start, const VectorType & step, TValue * values, SizeValueType count) const;
+
+  /** Evaluate the function over a grid of size points, at
+   * origin + steps * index, with the first grid axis varying fastest in the
+   * values, as in an image buffer. */
+  template <typename TValue>
+  void
+  EvaluateGrid(const TInput & origin, const MatrixType & steps, const SizeType & size, TValue * values) const;
+
   /** Set/Get the sinusoid phase shift in radians. */
   itkSetMacro(PhaseOffset, double);
   itkGetConstMacro(PhaseOffset, double);
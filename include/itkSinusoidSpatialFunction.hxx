@@ -18,6 +18,7 @@
 #ifndef itkSinusoidSpatialFunction_hxx
 #define itkSinusoidSpatialFunction_hxx
 
+#include <algorithm>
 #include <cmath>
 #include "vnl/vnl_math.h"
 #include "itkSinusoidSpatialFunction.h"
@@ -55,6 +56,115 @@ SinusoidSpatialFunction<TOutput, VImageDimension, TInput>::Evaluate(const TInput
 }
 
 
+template <typename TOutput, unsigned int VImageDimension, typename TInput>
+template <typename TValue>
+void
+SinusoidSpatialFunction<TOutput, VImageDimension, TInput>::Evaluate(const TInput * positions,
+                                                                    TValue *       values,
+                                                                    SizeValueType  count) const
+{
+  constexpr SizeValueType blockSize = 256;
+  double                  phases[blockSize];
+  const double            twoPi = 2.0 * vnl_math::pi;
+  for (SizeValueType begin = 0; begin < count; begin += blockSize)
+  {
+    const SizeValueType blockCount = std::min(blockSize, count - begin);
+    for (SizeValueType ii = 0; ii < blockCount; ++ii)
+    {
+      double frequencyTerm = 0.0;
+      for (unsigned int dd = 0; dd < VImageDimension; ++dd)
+      {
+        frequencyTerm += this->m_Frequency[dd] * positions[begin + ii][dd];
+      }
+      phases[ii] = frequencyTerm * twoPi + this->m_PhaseOffset;
+    }
+    for (SizeValueType ii = 0; ii < blockCount; ++ii)
+    {
+      values[begin + ii] = static_cast<TValue>(std::cos(phases[ii]));
+    }
+  }
+}
+
+
+template <typename TOutput, unsigned int VImageDimension, typename TInput>
+template <typename TValue>
+void
+SinusoidSpatialFunction<TOutput, VImageDimension, TInput>::EvaluateLine(const TInput &     start,
+                                                                        const VectorType & step,
+                                                                        TValue *           values,
+                                                                        SizeValueType      count) const
+{
+  // Number of points advanced by the recurrence between direct evaluations
+  constexpr SizeValueType anchorInterval = 64;
+
+  const double twoPi = 2.0 * vnl_math::pi;
+  double       startPhase = 0.0;
+  double       phaseStep = 0.0;
+  for (unsigned int dd = 0; dd < VImageDimension; ++dd)
+  {
+    startPhase += this->m_Frequency[dd] * start[dd];
+    phaseStep += this->m_Frequency[dd] * step[dd];
+  }
+  startPhase = startPhase * twoPi + this->m_PhaseOffset;
+  phaseStep *= twoPi;
+  const double cosineStep = std::cos(phaseStep);
+  const double sineStep = std::sin(phaseStep);
+
+  for (SizeValueType anchor = 0; anchor < count; anchor += anchorInterval)
+  {
+    const double        phase = startPhase + double(anchor) * phaseStep;
+    double              cosine = std::cos(phase);
+    double              sine = std::sin(phase);
+    const SizeValueType end = std::min(count, anchor + anchorInterval);
+    for (SizeValueType ii = anchor; ii < end; ++ii)
+    {
+      values[ii] = static_cast<TValue>(cosine);
+      const double nextCosine = cosine * cosineStep - sine * sineStep;
+      sine = sine * cosineStep + cosine * sineStep;
+      cosine = nextCosine;
+    }
+  }
+}
+
+
+template <typename TOutput, unsigned int VImageDimension, typename TInput>
+template <typename TValue>
+void
+SinusoidSpatialFunction<TOutput, VImageDimension, TInput>::EvaluateGrid(const TInput &     origin,
+                                                                        const MatrixType & steps,
+                                                                        const SizeType &   size,
+                                                                        TValue *           values) const
+{
+  VectorType lineStep;
+  for (unsigned int dd = 0; dd < VImageDimension; ++dd)
+  {
+    lineStep[dd] = steps(dd, 0);
+  }
+
+  SizeValueType numberOfLines = 1;
+  for (unsigned int dd = 1; dd < VImageDimension; ++dd)
+  {
+    numberOfLines *= size[dd];
+  }
+  for (SizeValueType line = 0; line < numberOfLines; ++line)
+  {
+    // Start of the line, from its index along the other grid axes
+    TInput        start = origin;
+    SizeValueType remainder = line;
+    for (unsigned int axis = 1; axis < VImageDimension; ++axis)
+    {
+      const double index = double(remainder % size[axis]);
+      remainder /= size[axis];
+      for (unsigned int dd = 0; dd < VImageDimension; ++dd)
+      {
+        start[dd] += steps(dd, axis) * index;
+      }
+    }
+    this->EvaluateLine(start, lineStep, values + line * size[0], size[0]);
+  }
+}
+
+
 template <typename TOutput, unsigned int VImageDimension, typename TInput>
 void
 SinusoidSpatialFunction<TOutput, VImageDimension, TInput>::PrintSelf(std::ostream & os, Indent indent) const
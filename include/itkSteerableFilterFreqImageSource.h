@@ -18,10 +18,12 @@
 #ifndef itkSteerableFilterFreqImageSource_h
 #define itkSteerableFilterFreqImageSource_h
 
-#include "itkImageSource.h"
+#include "itkGenerateImageSource.h"
 #include "itkFixedArray.h"
 #include "itkSize.h"
 #include "itkArray2D.h"
+#include "itkNumericTraits.h"
+#include "itkPhaseSymmetryAngularPolynomial.h"
 
 #include <vector>
 #include <complex>
@@ -30,15 +32,26 @@
 namespace itk
 {
 
+/** \class SteerableFilterFreqImageSource
+ * \brief Generate the angular Gaussian of an orientation in the frequency
+ * domain, centered at index size / 2.
+ *
+ * The size, spacing, origin, direction and start index of the output are
+ * those of GenerateImageSource. Only the requested region of the output is
+ * generated, so that the source can be streamed or generate sub-regions of
+ * the frequency domain.
+ *
+ * \ingroup PhaseSymmetry
+ */
 template <typename TOutputImage>
-class SteerableFilterFreqImageSource : public ImageSource<TOutputImage>
+class SteerableFilterFreqImageSource : public GenerateImageSource<TOutputImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_ASSIGN(SteerableFilterFreqImageSource);
 
   /** Standard class type alias. */
   using Self = SteerableFilterFreqImageSource;
-  using Superclass = ImageSource<TOutputImage>;
+  using Superclass = GenerateImageSource<TOutputImage>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
@@ -48,16 +61,8 @@ public:
   /** Typedef to describe the output image region type. */
   using OutputImageRegionType = typename TOutputImage::RegionType;
 
-  /** Spacing type alias support.  Spacing holds the size of a pixel.  The
-   * spacing is the geometric distance between image samples. */
   using SpacingType = typename TOutputImage::SpacingType;
-
-  /** Origin type alias support.  The origin is the geometric coordinates
-   * of the index (0,0). */
   using PointType = typename TOutputImage::PointType;
-
-  /** Direction type alias support.  The direction is the direction
-   * cosines of the image. */
   using DirectionType = typename TOutputImage::DirectionType;
 
   using RangeType = std::vector<std::vector<double>>;
@@ -65,59 +70,32 @@ public:
   /** Dimensionality of the output image */
   itkStaticConstMacro(NDimensions, unsigned int, TOutputImage::ImageDimension);
 
-  /** Type used to store gaussian parameters. */
-
-
-  // Type used to store the range for each axis
-
   /** Size type matches that used for images */
   using SizeType = typename TOutputImage::SizeType;
   using SizeValueType = typename TOutputImage::SizeValueType;
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(SteerableFilterFreqImageSource, ImageSource);
+  itkTypeMacro(SteerableFilterFreqImageSource, GenerateImageSource);
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
-  /** Specify the size of the output image. */
+  /** Set the size, the spacing and the origin of the output image from
+   * arrays, as well as from their types. */
+  using Superclass::SetSize;
+  using Superclass::SetSpacing;
+  using Superclass::SetOrigin;
   virtual void
   SetSize(const SizeValueType * values);
-
-  /** Specify the size of the output image. */
-  virtual void
-  SetSize(const SizeType values);
-
-  /** Get the size of the output image. */
-  itkGetVectorMacro(Size, const SizeValueType, NDimensions);
-
-  /** Specify the spacing of the output image. */
-  itkSetMacro(Spacing, SpacingType);
   virtual void
   SetSpacing(const float * values);
   virtual void
   SetSpacing(const double * values);
-
-  /** Get the spacing of the output image. */
-  itkGetConstReferenceMacro(Spacing, SpacingType);
-
-  /** Specify the origin of the output image. */
-  itkSetMacro(Origin, PointType);
   virtual void
   SetOrigin(const float * values);
   virtual void
   SetOrigin(const double * values);
 
-  /** Get the origin of the output image. */
-  itkGetConstReferenceMacro(Origin, PointType);
-
-  /** Specify the direction of the output image. */
-  itkSetMacro(Direction, DirectionType);
-
-  itkGetConstReferenceMacro(Direction, DirectionType);
-
-  // itkSetMacro(Ranges, RangeType);
-
   using DimMinusOneDoubleArrayType = FixedArray<double, TOutputImage::ImageDimension - 1>;
   using DoubleArrayType = FixedArray<double, TOutputImage::ImageDimension>;
 
@@ -127,6 +105,20 @@ public:
   itkSetMacro(AngularBandwidth, double);
   itkGetConstReferenceMacro(AngularBandwidth, double);
 
+  /** Set/Get the maximum absolute error of a fast evaluation of the angular
+   * Gaussian. Zero, the default, evaluates it exactly.
+   *
+   * The fast evaluation keeps the inverse frequency radius of every pixel,
+   * which with the frequency, linear in the index, makes up the unit
+   * direction field. It is computed once per size and requested region, so
+   * that each further orientation costs a dot product and a Chebyshev
+   * polynomial in the cosine of the half angle,
+   * cos(angle / 2) = sqrt((1 + cos(angle)) / 2), in which the angular
+   * Gaussian is smooth. The polynomial degree is the lowest that
+   * meets the tolerance; if none up to 256 does, the evaluation is exact. */
+  itkSetClampMacro(AngularTolerance, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(AngularTolerance, double);
+
 protected:
   SteerableFilterFreqImageSource();
   ~SteerableFilterFreqImageSource() override;
@@ -135,16 +127,22 @@ protected:
   void
   DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
   void
-  GenerateOutputInformation() override;
+  BeforeThreadedGenerateData() override;
 
 private:
-  SizeValueType m_Size[NDimensions]; // size of the output image
-  SpacingType   m_Spacing;           // spacing
-  PointType     m_Origin;            // origin
-  DirectionType m_Direction;         // direction
-
   DoubleArrayType m_Orientation;
   double          m_AngularBandwidth;
+  double          m_AngularTolerance{ 0.0 };
+
+  // Fast evaluation state, derived from the parameters in
+  // BeforeThreadedGenerateData()
+  bool                           m_UseAngularPolynomial{ false };
+  PhaseSymmetryAngularPolynomial m_AngularPolynomial;
+  double                         m_AngularPolynomialExponentScale{ 0.0 };
+  double                         m_AngularPolynomialTolerance{ 0.0 };
+  std::vector<float>             m_InverseRadius;
+  SizeType                       m_InverseRadiusSize;
+  OutputImageRegionType          m_InverseRadiusRegion;
 };
 
 } // end namespace itk
@@ -19,10 +19,11 @@
 #define itkSteerableFilterFreqImageSource_hxx
 
 #include "itkSteerableFilterFreqImageSource.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageScanlineIterator.h"
 #include "itkProgressReporter.h"
 #include "itkObjectFactory.h"
 #include <algorithm>
+#include <cmath>
 
 namespace itk
 {
@@ -31,15 +32,9 @@ template <typename TOutputImage>
 SteerableFilterFreqImageSource<TOutputImage>::SteerableFilterFreqImageSource()
 {
   // Initial image is 64 wide in each direction.
-  for (unsigned int i = 0; i < TOutputImage::GetImageDimension(); i++)
-  {
-    m_Size[i] = 64;
-    m_Spacing[i] = 1.0;
-    m_Origin[i] = 0.0;
-  }
-  m_Direction.SetIdentity();
-
-  // this->ReleaseDataBeforeUpdateFlagOn();
+  SizeType size;
+  size.Fill(64);
+  this->SetSize(size);
 }
 
 
@@ -52,28 +47,92 @@ void
 SteerableFilterFreqImageSource<TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "Orientation: " << m_Orientation << std::endl;
+  os << indent << "AngularBandwidth: " << m_AngularBandwidth << std::endl;
+  os << indent << "AngularTolerance: " << m_AngularTolerance << std::endl;
 }
 
 
 template <typename TOutputImage>
 void
-SteerableFilterFreqImageSource<TOutputImage>::GenerateOutputInformation()
+SteerableFilterFreqImageSource<TOutputImage>::BeforeThreadedGenerateData()
 {
-  TOutputImage *                   output;
-  typename TOutputImage::IndexType index = { { 0 } };
-  typename TOutputImage::SizeType  size = { { 0 } };
-  size.SetSize(m_Size);
+  const double angularSigma = (m_AngularBandwidth / 2) / 1.1774;
+  const double exponentScale = -1.0 / (2 * angularSigma * angularSigma);
 
-  output = this->GetOutput(0);
+  m_UseAngularPolynomial = false;
+  if (m_AngularTolerance <= 0.0)
+  {
+    m_InverseRadius.clear();
+    return;
+  }
 
-  typename TOutputImage::RegionType largestPossibleRegion;
-  largestPossibleRegion.SetSize(size);
-  largestPossibleRegion.SetIndex(index);
-  output->SetLargestPossibleRegion(largestPossibleRegion);
+  // The polynomial depends on the bandwidth and the tolerance only
+  if (m_AngularPolynomialExponentScale != exponentScale || m_AngularPolynomialTolerance != m_AngularTolerance)
+  {
+    m_AngularPolynomialExponentScale = exponentScale;
+    m_AngularPolynomialTolerance = m_AngularTolerance;
+    if (!m_AngularPolynomial.Fit(exponentScale, m_AngularTolerance))
+    {
+      itkWarningMacro(<< "No polynomial meets the angular tolerance " << m_AngularTolerance
+                      << " for the angular bandwidth " << m_AngularBandwidth << "; evaluating exactly");
+    }
+  }
+  if (m_AngularPolynomial.GetNumberOfCoefficients() == 0)
+  {
+    return;
+  }
+  m_UseAngularPolynomial = true;
+
+  // The inverse radius depends on the size and the buffered region only, so
+  // that it is kept across orientations. It covers the buffered region, so
+  // that a streamed or sub-region output keeps no more than its own pixels.
+  TOutputImage *              outputPtr = this->GetOutput();
+  const SizeType              size = outputPtr->GetLargestPossibleRegion().GetSize();
+  const OutputImageRegionType bufferedRegion = outputPtr->GetBufferedRegion();
+  if (m_InverseRadius.empty() || m_InverseRadiusSize != size || m_InverseRadiusRegion != bufferedRegion)
+  {
+    m_InverseRadiusSize = size;
+    m_InverseRadiusRegion = bufferedRegion;
+    m_InverseRadius.resize(bufferedRegion.GetNumberOfPixels());
 
-  output->SetSpacing(m_Spacing);
-  output->SetOrigin(m_Origin);
-  output->SetDirection(m_Direction);
+    DoubleArrayType centerPoint;
+    DoubleArrayType scale;
+    for (unsigned int i = 0; i < NDimensions; i++)
+    {
+      centerPoint[i] = double(size[i]) / 2.0;
+      scale[i] = 1.0 / double(size[i]);
+    }
+
+    float * inverseRadius = m_InverseRadius.data();
+    this->GetMultiThreader()->template ParallelizeImageRegion<NDimensions>(
+      bufferedRegion,
+      [outputPtr, centerPoint, scale, inverseRadius](const OutputImageRegionType & region) {
+        const SizeValueType                 lineLength = region.GetSize(0);
+        ImageScanlineIterator<TOutputImage> it(outputPtr, region);
+        while (!it.IsAtEnd())
+        {
+          const typename TOutputImage::IndexType index = it.GetIndex();
+          double                                 lineRadius = 0;
+          for (unsigned int i = 1; i < NDimensions; i++)
+          {
+            const double dist = (double(index[i]) - centerPoint[i]) * scale[i];
+            lineRadius += dist * dist;
+          }
+          float *      lineInverseRadius = inverseRadius + outputPtr->ComputeOffset(index);
+          const double lineStart = double(index[0]) - centerPoint[0];
+          for (SizeValueType x = 0; x < lineLength; ++x)
+          {
+            const double dist = (lineStart + double(x)) * scale[0];
+            const double radius = std::sqrt(lineRadius + dist * dist);
+            lineInverseRadius[x] = radius == 0 ? 0.0f : static_cast<float>(1.0 / radius);
+          }
+          it.NextLine();
+        }
+      },
+      nullptr);
+  }
 }
 
 
@@ -82,202 +141,123 @@ void
 SteerableFilterFreqImageSource<TOutputImage>::DynamicThreadedGenerateData(
   const OutputImageRegionType & outputRegionForThread)
 {
-  // The a pointer to the output image
-
-  typename TOutputImage::Pointer outputPtr = this->GetOutput();
-  // outputPtr->SetBufferedRegion( outputRegionForThread );
-  // outputPtr->Allocate();
-
+  TOutputImage * outputPtr = this->GetOutput();
+  const SizeType size = outputPtr->GetLargestPossibleRegion().GetSize();
 
-  using OutputIterator = ImageRegionIteratorWithIndex<TOutputImage>;
-  OutputIterator outIt = OutputIterator(outputPtr, outputRegionForThread);
+  const double angularSigma = (m_AngularBandwidth / 2) / 1.1774;
+  const double exponentScale = -1.0 / (2 * angularSigma * angularSigma);
 
-  int ndims = TOutputImage::ImageDimension;
-
-  double angularSigma;
-  angularSigma = (m_AngularBandwidth / 2) / 1.1774;
-
-
-  double          dangle;
   double          orientationRadius = 0;
-  DoubleArrayType dist;
   DoubleArrayType centerPoint;
-
-  double radius = 0;
-  double angularGaussianValue = 0;
-  double dotProduct = 0;
-
-  for (int i = 0; i < ndims; i++)
+  DoubleArrayType scale;
+  for (unsigned int i = 0; i < NDimensions; i++)
   {
     orientationRadius = orientationRadius + m_Orientation[i] * m_Orientation[i];
-    centerPoint[i] = double(m_Size[i]) / 2.0;
+    centerPoint[i] = double(size[i]) / 2.0;
+    scale[i] = 1.0 / double(size[i]);
   }
-  orientationRadius = sqrt(orientationRadius);
+  const double inverseOrientationRadius = 1.0 / std::sqrt(orientationRadius);
 
-  typename TOutputImage::IndexType index;
-  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+  const SizeValueType                 lineLength = outputRegionForThread.GetSize(0);
+  ImageScanlineIterator<TOutputImage> outIt(outputPtr, outputRegionForThread);
+  while (!outIt.IsAtEnd())
   {
-    index = outIt.GetIndex();
-    radius = 0;
-    dotProduct = 0;
+    const typename TOutputImage::IndexType index = outIt.GetIndex();
 
-    for (unsigned int i = 0; i < TOutputImage::ImageDimension; i++)
+    // Squared radius and projection on the orientation of the axes other
+    // than the scanline axis
+    double lineRadius = 0;
+    double lineDotProduct = 0;
+    for (unsigned int i = 1; i < NDimensions; i++)
     {
-      dist[i] = (double(index[i]) - centerPoint[i]) / double(m_Size[i]);
-      dotProduct = dotProduct + m_Orientation[i] * dist[i];
-      radius = radius + (dist[i] * dist[i]);
+      const double dist = (double(index[i]) - centerPoint[i]) * scale[i];
+      lineDotProduct = lineDotProduct + m_Orientation[i] * dist;
+      lineRadius = lineRadius + dist * dist;
     }
-    radius = sqrt(radius);
-    dotProduct = dotProduct / (radius * orientationRadius);
-    dangle = acos(dotProduct);
 
-
-    angularGaussianValue = exp(-((dangle * dangle) / (2 * angularSigma * angularSigma)));
-    if (radius == 0)
+    OutputImagePixelType * out = &outIt.Value();
+    const double           lineStart = double(index[0]) - centerPoint[0];
+    if (m_UseAngularPolynomial)
     {
-      angularGaussianValue = 1.0;
+      // Only the dot product with the kept unit direction field, and the
+      // polynomial, per pixel
+      const float * inverseRadius = m_InverseRadius.data() + outputPtr->ComputeOffset(index);
+      for (SizeValueType x = 0; x < lineLength; ++x)
+      {
+        const double dist = (lineStart + double(x)) * scale[0];
+        const double dotProduct =
+          (lineDotProduct + m_Orientation[0] * dist) * inverseOrientationRadius * inverseRadius[x];
+        const double angularGaussianValue = m_AngularPolynomial.Evaluate(dotProduct);
+        out[x] = static_cast<OutputImagePixelType>(inverseRadius[x] == 0.0f ? 1.0 : angularGaussianValue);
+      }
+      outIt.NextLine();
+      continue;
     }
-    // Set the pixel value to the function value
-    outIt.Set((typename TOutputImage::PixelType)angularGaussianValue);
-  }
-}
 
-
-template <typename TOutputImage>
-void
-SteerableFilterFreqImageSource<TOutputImage>::SetSpacing(const float * spacing)
-{
-  unsigned int i;
-  for (i = 0; i < TOutputImage::ImageDimension; i++)
-  {
-    if ((double)spacing[i] != m_Spacing[i])
+    // The scanline is contiguous in the buffer, and each pixel is computed
+    // from the contributions of the slower axes to the line
+    for (SizeValueType x = 0; x < lineLength; ++x)
     {
-      break;
+      const double dist = (lineStart + double(x)) * scale[0];
+      const double radius = std::sqrt(lineRadius + dist * dist);
+      const double dotProduct = (lineDotProduct + m_Orientation[0] * dist) * inverseOrientationRadius / radius;
+      // Rounding may take the cosine out of [-1, 1]
+      const double dangle = std::acos(std::max(-1.0, std::min(1.0, dotProduct)));
+      const double angularGaussianValue = std::exp(dangle * dangle * exponentScale);
+      out[x] = static_cast<OutputImagePixelType>(radius == 0 ? 1.0 : angularGaussianValue);
     }
-  }
-  if (i < TOutputImage::ImageDimension)
-  {
-    for (i = 0; i < TOutputImage::ImageDimension; i++)
-    {
-      m_Spacing[i] = spacing[i];
-    }
-    this->Modified();
+    outIt.NextLine();
   }
 }
 
 
 template <typename TOutputImage>
 void
-SteerableFilterFreqImageSource<TOutputImage>::SetSpacing(const double * spacing)
+SteerableFilterFreqImageSource<TOutputImage>::SetSize(const SizeValueType * values)
 {
-  unsigned int i;
-  for (i = 0; i < TOutputImage::ImageDimension; i++)
-  {
-    if (spacing[i] != m_Spacing[i])
-    {
-      break;
-    }
-  }
-  if (i < TOutputImage::ImageDimension)
-  {
-    for (i = 0; i < TOutputImage::ImageDimension; i++)
-    {
-      m_Spacing[i] = spacing[i];
-    }
-    this->Modified();
-  }
+  SizeType size;
+  size.SetSize(values);
+  this->SetSize(size);
 }
 
 
 template <typename TOutputImage>
 void
-SteerableFilterFreqImageSource<TOutputImage>::SetOrigin(const float * origin)
+SteerableFilterFreqImageSource<TOutputImage>::SetSpacing(const float * values)
 {
-  unsigned int i;
-  for (i = 0; i < TOutputImage::ImageDimension; i++)
-  {
-    if ((double)origin[i] != m_Origin[i])
-    {
-      break;
-    }
-  }
-  if (i < TOutputImage::ImageDimension)
-  {
-    for (i = 0; i < TOutputImage::ImageDimension; i++)
-    {
-      m_Origin[i] = origin[i];
-    }
-    this->Modified();
-  }
+  SpacingType spacing;
+  std::copy(values, values + NDimensions, spacing.Begin());
+  this->SetSpacing(spacing);
 }
 
 
 template <typename TOutputImage>
 void
-SteerableFilterFreqImageSource<TOutputImage>::SetOrigin(const double * origin)
+SteerableFilterFreqImageSource<TOutputImage>::SetSpacing(const double * values)
 {
-  unsigned int i;
-  for (i = 0; i < TOutputImage::ImageDimension; i++)
-  {
-    if (origin[i] != m_Origin[i])
-    {
-      break;
-    }
-  }
-  if (i < TOutputImage::ImageDimension)
-  {
-    for (i = 0; i < TOutputImage::ImageDimension; i++)
-    {
-      m_Origin[i] = origin[i];
-    }
-    this->Modified();
-  }
+  SpacingType spacing;
+  std::copy(values, values + NDimensions, spacing.Begin());
+  this->SetSpacing(spacing);
 }
 
 
 template <typename TOutputImage>
 void
-SteerableFilterFreqImageSource<TOutputImage>::SetSize(const SizeValueType * size)
+SteerableFilterFreqImageSource<TOutputImage>::SetOrigin(const float * values)
 {
-  unsigned int i;
-  for (i = 0; i < TOutputImage::ImageDimension; i++)
-  {
-    if (size[i] != m_Size[i])
-    {
-      break;
-    }
-  }
-  if (i < TOutputImage::ImageDimension)
-  {
-    for (i = 0; i < TOutputImage::ImageDimension; i++)
-    {
-      m_Size[i] = size[i];
-    }
-    this->Modified();
-  }
+  PointType origin;
+  std::copy(values, values + NDimensions, origin.Begin());
+  this->SetOrigin(origin);
 }
 
 
 template <typename TOutputImage>
 void
-SteerableFilterFreqImageSource<TOutputImage>::SetSize(const SizeType size)
+SteerableFilterFreqImageSource<TOutputImage>::SetOrigin(const double * values)
 {
-  unsigned int i;
-  for (i = 0; i < TOutputImage::ImageDimension; i++)
-  {
-    if (size[i] != m_Size[i])
-    {
-      break;
-    }
-  }
-  if (i < TOutputImage::ImageDimension)
-  {
-    for (i = 0; i < TOutputImage::ImageDimension; i++)
-    {
-      m_Size[i] = size[i];
-    }
-    this->Modified();
-  }
+  PointType origin;
+  std::copy(values, values + NDimensions, origin.Begin());
+  this->SetOrigin(origin);
 }
 
 } // end namespace itk
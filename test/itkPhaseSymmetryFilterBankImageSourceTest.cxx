@@ -0,0 +1,300 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryFilterBankImageSource.h"
+#include "itkLogGaborFreqImageSource.h"
+#include "itkButterworthFilterFreqImageSource.h"
+#include "itkSteerableFilterFreqImageSource.h"
+#include "itkFFTShiftImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Checks that the entries of the filter bank source match the products of
+// the log Gabor, Butterworth and steerable sources moved to FFT layout, and
+// that the factorized outputs multiply into the entries, for even sizes, on
+// which both layouts agree. For odd sizes, whose centered layout is half a
+// bin off the DFT grid, checks the entries against the kernels evaluated at
+// the frequencies of the DFT bins.
+
+namespace
+{
+
+template <typename TImage>
+double
+MaximumAbsoluteDifference(const TImage * image, const TImage * reference, double scale = 1.0)
+{
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> referenceIt(reference, reference->GetBufferedRegion());
+  double                                difference = 0.0;
+  for (; !it.IsAtEnd(); ++it, ++referenceIt)
+  {
+    difference = std::max(difference, std::abs(double(it.Get()) - scale * double(referenceIt.Get())));
+  }
+  return difference;
+}
+
+
+template <unsigned int VDimension>
+bool
+CheckFilterBank(const itk::Size<VDimension> & size)
+{
+  using ImageType = itk::Image<float, VDimension>;
+  using FilterBankSourceType = itk::PhaseSymmetryFilterBankImageSource<ImageType>;
+  using MatrixType = typename FilterBankSourceType::MatrixType;
+
+  MatrixType wavelengths(2, VDimension);
+  MatrixType orientations(3, VDimension);
+  for (unsigned int dd = 0; dd < VDimension; ++dd)
+  {
+    wavelengths(0, dd) = 4.0 + dd;
+    wavelengths(1, dd) = 9.0;
+    orientations(0, dd) = dd == 0 ? 1.0 : 0.0;
+    orientations(1, dd) = dd == 1 ? 1.0 : 0.0;
+    orientations(2, dd) = 0.5 + dd;
+  }
+  const double sigma = 0.55;
+  const double angularBandwidth = 1.5;
+
+  typename FilterBankSourceType::Pointer filterBankSource = FilterBankSourceType::New();
+  filterBankSource->SetSize(size);
+  filterBankSource->SetWavelengths(wavelengths);
+  filterBankSource->SetOrientations(orientations);
+  filterBankSource->SetSigma(sigma);
+  filterBankSource->SetAngularBandwidth(angularBandwidth);
+  filterBankSource->Update();
+
+  typename FilterBankSourceType::Pointer factorSource = FilterBankSourceType::New();
+  factorSource->SetSize(size);
+  factorSource->SetWavelengths(wavelengths);
+  factorSource->SetOrientations(orientations);
+  factorSource->SetSigma(sigma);
+  factorSource->SetAngularBandwidth(angularBandwidth);
+  factorSource->FactorizedOutputsOn();
+  factorSource->Update();
+
+  using LogGaborSourceType = itk::LogGaborFreqImageSource<ImageType>;
+  using ButterworthSourceType = itk::ButterworthFilterFreqImageSource<ImageType>;
+  using SteerableSourceType = itk::SteerableFilterFreqImageSource<ImageType>;
+  using ShiftFilterType = itk::FFTShiftImageFilter<ImageType, ImageType>;
+
+  typename ButterworthSourceType::Pointer butterworthSource = ButterworthSourceType::New();
+  butterworthSource->SetSize(size);
+  butterworthSource->SetCutoff(0.4);
+  butterworthSource->SetOrder(10.0);
+  butterworthSource->Update();
+
+  double difference = 0.0;
+  double factorDifference = 0.0;
+  for (unsigned int ww = 0; ww < wavelengths.rows(); ++ww)
+  {
+    typename LogGaborSourceType::Pointer logGaborSource = LogGaborSourceType::New();
+    logGaborSource->SetSize(size);
+    logGaborSource->SetSigma(sigma);
+    typename LogGaborSourceType::ArrayType wavelength;
+    for (unsigned int dd = 0; dd < VDimension; ++dd)
+    {
+      wavelength[dd] = wavelengths(ww, dd);
+    }
+    logGaborSource->SetWavelengths(wavelength);
+    logGaborSource->Update();
+
+    for (unsigned int oo = 0; oo < orientations.rows(); ++oo)
+    {
+      typename SteerableSourceType::Pointer steerableSource = SteerableSourceType::New();
+      steerableSource->SetSize(size);
+      steerableSource->SetAngularBandwidth(angularBandwidth);
+      typename SteerableSourceType::DoubleArrayType orientation;
+      for (unsigned int dd = 0; dd < VDimension; ++dd)
+      {
+        orientation[dd] = orientations(oo, dd);
+      }
+      steerableSource->SetOrientation(orientation);
+      steerableSource->Update();
+
+      // Centered product of the three kernels, moved to FFT layout
+      typename ImageType::Pointer product = ImageType::New();
+      product->CopyInformation(logGaborSource->GetOutput());
+      product->SetRegions(logGaborSource->GetOutput()->GetBufferedRegion());
+      product->Allocate();
+      itk::ImageRegionConstIterator<ImageType> logGaborIt(logGaborSource->GetOutput(),
+                                                          product->GetBufferedRegion());
+      itk::ImageRegionConstIterator<ImageType> butterworthIt(butterworthSource->GetOutput(),
+                                                             product->GetBufferedRegion());
+      itk::ImageRegionConstIterator<ImageType> steerableIt(steerableSource->GetOutput(),
+                                                           product->GetBufferedRegion());
+      itk::ImageRegionIterator<ImageType>      productIt(product, product->GetBufferedRegion());
+      for (; !productIt.IsAtEnd(); ++productIt, ++logGaborIt, ++butterworthIt, ++steerableIt)
+      {
+        productIt.Set(logGaborIt.Get() * butterworthIt.Get() * steerableIt.Get());
+      }
+      typename ShiftFilterType::Pointer shiftFilter = ShiftFilterType::New();
+      shiftFilter->SetInput(product);
+      shiftFilter->Update();
+
+      const ImageType * entry = filterBankSource->GetEntryOutput(ww, oo);
+      difference = std::max(difference, MaximumAbsoluteDifference(entry, shiftFilter->GetOutput()));
+
+      // Factors
+      typename ImageType::Pointer factorProduct = ImageType::New();
+      factorProduct->CopyInformation(entry);
+      factorProduct->SetRegions(entry->GetBufferedRegion());
+      factorProduct->Allocate();
+      itk::ImageRegionConstIterator<ImageType> scaleIt(factorSource->GetScaleFactorOutput(ww),
+                                                       entry->GetBufferedRegion());
+      itk::ImageRegionConstIterator<ImageType> orientationIt(factorSource->GetOrientationFactorOutput(oo),
+                                                             entry->GetBufferedRegion());
+      itk::ImageRegionIterator<ImageType>      factorIt(factorProduct, entry->GetBufferedRegion());
+      for (; !factorIt.IsAtEnd(); ++factorIt, ++scaleIt, ++orientationIt)
+      {
+        factorIt.Set(scaleIt.Get() * orientationIt.Get());
+      }
+      factorDifference = std::max(factorDifference, MaximumAbsoluteDifference(entry, factorProduct.GetPointer()));
+    }
+  }
+
+  std::cout << size << ": maximum absolute difference " << difference << " to the separate sources, "
+            << factorDifference << " to the factors" << std::endl;
+  return difference <= 1e-5 && factorDifference <= 1e-6;
+}
+
+
+// Compare every entry with the product of the kernels at the frequency of
+// its DFT bin: along an axis of size n, index i holds the bin i / n for
+// 2 i < n, and (i - n) / n otherwise
+template <unsigned int VDimension>
+bool
+CheckDFTFrequencies(const itk::Size<VDimension> & size)
+{
+  using ImageType = itk::Image<float, VDimension>;
+  using FilterBankSourceType = itk::PhaseSymmetryFilterBankImageSource<ImageType>;
+  using MatrixType = typename FilterBankSourceType::MatrixType;
+
+  MatrixType wavelengths(2, VDimension);
+  MatrixType orientations(2, VDimension);
+  for (unsigned int dd = 0; dd < VDimension; ++dd)
+  {
+    wavelengths(0, dd) = 3.0 + dd;
+    wavelengths(1, dd) = 7.0;
+    orientations(0, dd) = dd == 0 ? 1.0 : 0.0;
+    orientations(1, dd) = 1.0 + dd;
+  }
+  const double sigma = 0.55;
+  const double angularBandwidth = 1.5;
+  const double cutoff = 0.4;
+  const double order = 10.0;
+
+  typename FilterBankSourceType::Pointer filterBankSource = FilterBankSourceType::New();
+  filterBankSource->SetSize(size);
+  filterBankSource->SetWavelengths(wavelengths);
+  filterBankSource->SetOrientations(orientations);
+  filterBankSource->SetSigma(sigma);
+  filterBankSource->SetAngularBandwidth(angularBandwidth);
+  filterBankSource->SetCutoff(cutoff);
+  filterBankSource->SetOrder(order);
+  filterBankSource->Update();
+
+  const double angularSigma = (angularBandwidth / 2) / 1.1774;
+  double       difference = 0.0;
+  for (unsigned int ww = 0; ww < wavelengths.rows(); ++ww)
+  {
+    for (unsigned int oo = 0; oo < orientations.rows(); ++oo)
+    {
+      const ImageType * entry = filterBankSource->GetEntryOutput(ww, oo);
+      for (itk::ImageRegionConstIteratorWithIndex<ImageType> it(entry, entry->GetBufferedRegion()); !it.IsAtEnd();
+           ++it)
+      {
+        double frequency[VDimension];
+        double radius = 0.0;
+        double weightedRadius = 0.0;
+        double orientationNorm = 0.0;
+        double dotProduct = 0.0;
+        for (unsigned int dd = 0; dd < VDimension; ++dd)
+        {
+          const auto n = static_cast<double>(size[dd]);
+          const auto ii = static_cast<double>(it.GetIndex()[dd]);
+          frequency[dd] = (2.0 * ii < n ? ii : ii - n) / n;
+          radius += frequency[dd] * frequency[dd];
+          weightedRadius += std::pow(frequency[dd] * wavelengths(ww, dd), 2.0);
+          orientationNorm += orientations(oo, dd) * orientations(oo, dd);
+          dotProduct += orientations(oo, dd) * frequency[dd];
+        }
+        radius = std::sqrt(radius);
+
+        double expected = 0.0;
+        if (radius > 0.0)
+        {
+          const double logGabor =
+            std::exp(-std::pow(std::log(std::sqrt(weightedRadius)), 2.0) / (2.0 * std::pow(std::log(sigma), 2.0)));
+          const double lowPass = 1.0 / (1.0 + std::pow(radius / cutoff, 2.0 * order));
+          const double cosine = dotProduct / (std::sqrt(orientationNorm) * radius);
+          const double angle = std::acos(std::max(-1.0, std::min(1.0, cosine)));
+          const double angular = std::exp(-angle * angle / (2.0 * angularSigma * angularSigma));
+          expected = logGabor * lowPass * angular;
+        }
+        difference = std::max(difference, std::abs(double(it.Get()) - expected));
+      }
+    }
+  }
+
+  std::cout << size << ": maximum absolute difference " << difference << " to the kernels on the DFT bins"
+            << std::endl;
+  return difference <= 1e-5;
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryFilterBankImageSourceTest(int, char *[])
+{
+  using ImageType = itk::Image<float, 2>;
+  using FilterBankSourceType = itk::PhaseSymmetryFilterBankImageSource<ImageType>;
+
+  FilterBankSourceType::Pointer filterBankSource = FilterBankSourceType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filterBankSource, PhaseSymmetryFilterBankImageSource, GenerateImageSource);
+
+  // The number of columns must match the image dimension
+  FilterBankSourceType::MatrixType wrongWavelengths(2, 3);
+  ITK_TRY_EXPECT_EXCEPTION(filterBankSource->SetWavelengths(wrongWavelengths));
+
+  bool success = true;
+
+  itk::Size<2> size2D = { { 16, 12 } };
+  success &= CheckFilterBank<2>(size2D);
+  itk::Size<3> size3D = { { 8, 6, 4 } };
+  success &= CheckFilterBank<3>(size3D);
+
+  itk::Size<2> oddSize2D = { { 15, 9 } };
+  success &= CheckDFTFrequencies<2>(oddSize2D);
+  itk::Size<3> oddSize3D = { { 7, 5, 3 } };
+  success &= CheckDFTFrequencies<3>(oddSize3D);
+  success &= CheckDFTFrequencies<2>(size2D);
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
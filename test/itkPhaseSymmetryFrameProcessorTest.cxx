@@ -0,0 +1,129 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryFrameProcessor.h"
+#include "itkPhaseSymmetryTestHelpers.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Checks that PhaseSymmetryFrameProcessor reproduces PhaseSymmetryImageFilter
+// frame by frame, keeps frames in push order and bounds its ring buffer.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 2;
+using PixelType = float;
+using ImageType = itk::Image<PixelType, Dimension>;
+using ProcessorType = itk::PhaseSymmetryFrameProcessor<PixelType, PixelType>;
+using FilterType = ProcessorType::FilterType;
+
+using PhaseSymmetryTestHelpers::ConfigureFilter;
+using PhaseSymmetryTestHelpers::MaximumAbsoluteDifference;
+
+ImageType::Pointer
+MakeFrame(double phase)
+{
+  ImageType::SizeType size;
+  size.Fill(64);
+  return PhaseSymmetryTestHelpers::MakeInput<ImageType>(size, phase);
+}
+
+
+ImageType::Pointer
+RunFilter(const ImageType * frame)
+{
+  return PhaseSymmetryTestHelpers::RunFilter(PhaseSymmetryTestHelpers::MakeFilter<FilterType>(frame));
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryFrameProcessorTest(int, char *[])
+{
+  constexpr unsigned int numberOfFrames = 3;
+  constexpr double       tolerance = 1e-4;
+
+  std::vector<ImageType::Pointer> frames;
+  std::vector<ImageType::Pointer> references;
+  for (unsigned int i = 0; i < numberOfFrames; ++i)
+  {
+    frames.push_back(MakeFrame(0.4 * i));
+    references.push_back(RunFilter(frames[i]));
+  }
+
+  ProcessorType::Pointer processor = ProcessorType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(processor, PhaseSymmetryFrameProcessor, Object);
+
+  ConfigureFilter(processor->GetFilter());
+  processor->SetFrameSize(frames[0]->GetLargestPossibleRegion().GetSize());
+  processor->SetRingBufferLength(numberOfFrames - 1);
+  processor->SetNumberOfThreads(2);
+  ITK_TRY_EXPECT_NO_EXCEPTION(processor->Start());
+
+  bool                   success = true;
+  std::vector<PixelType> result(frames[0]->GetLargestPossibleRegion().GetNumberOfPixels());
+
+  // Synchronous processing
+  for (unsigned int i = 0; i < numberOfFrames; ++i)
+  {
+    ITK_TEST_EXPECT_TRUE(processor->ProcessFrame(frames[i]->GetBufferPointer(), result.data()));
+    const double difference = MaximumAbsoluteDifference(references[i].GetPointer(), result);
+    std::cout << "Frame " << i << ": maximum absolute difference " << difference << std::endl;
+    if (difference > tolerance)
+    {
+      std::cerr << "Frame " << i << " differs from the filter by " << difference << std::endl;
+      success = false;
+    }
+  }
+
+  // A full ring buffer refuses frames, and results come back in push order
+  ITK_TEST_EXPECT_TRUE(processor->PushFrame(frames[2]->GetBufferPointer()));
+  ITK_TEST_EXPECT_TRUE(processor->PushFrame(frames[1]->GetBufferPointer()));
+  ITK_TEST_EXPECT_TRUE(!processor->PushFrame(frames[0]->GetBufferPointer()));
+  ITK_TEST_EXPECT_TRUE(processor->PopResult(result.data()));
+  success &= MaximumAbsoluteDifference(references[2].GetPointer(), result) <= tolerance;
+  ITK_TEST_EXPECT_TRUE(processor->PopResult(result.data()));
+  success &= MaximumAbsoluteDifference(references[1].GetPointer(), result) <= tolerance;
+  ITK_TEST_EXPECT_TRUE(!processor->PopResult(result.data(), false));
+
+  ITK_TEST_EXPECT_EQUAL(processor->GetNumberOfProcessedFrames(), numberOfFrames + 2);
+  std::cout << "Latency p50: " << processor->GetLatencyP50() << " s, p99: " << processor->GetLatencyP99() << " s"
+            << std::endl;
+  ITK_TEST_EXPECT_TRUE(processor->GetLatencyP50() > 0.0);
+  ITK_TEST_EXPECT_TRUE(processor->GetLatencyP50() <= processor->GetLatencyP99());
+
+  processor->Stop();
+  ITK_TEST_EXPECT_TRUE(!processor->PushFrame(frames[0]->GetBufferPointer()));
+
+  processor->ResetLatencyHistogram();
+  ITK_TEST_EXPECT_EQUAL(processor->GetNumberOfProcessedFrames(), 0u);
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,587 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryImageFilter.h"
+#include "itkPhaseSymmetryTestHelpers.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+// Checks that the execution modes of PhaseSymmetryImageFilter, which trade
+// memory or time for one another, reproduce the default execution.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 3;
+using PixelType = float;
+using ImageType = itk::Image<PixelType, Dimension>;
+using FilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
+using SourceType = itk::SinusoidImageSource<ImageType>;
+
+using PhaseSymmetryTestHelpers::MakeInput;
+using PhaseSymmetryTestHelpers::MakeSource;
+using PhaseSymmetryTestHelpers::MaximumAbsoluteDifference;
+using PhaseSymmetryTestHelpers::RunFilter;
+
+// Four scales instead of the usual three
+template <typename TFilter = FilterType>
+typename TFilter::Pointer
+MakeFilter(const typename TFilter::InputImageType * input)
+{
+  return PhaseSymmetryTestHelpers::MakeFilter<TFilter>(input, { 4.0, 8.0, 12.0, 16.0 });
+}
+
+
+// Quantizes the input to the values of an integer image and returns both the
+// integer image and its exact floating point copy
+template <typename TIntegerImage>
+typename TIntegerImage::Pointer
+QuantizeInput(const ImageType * input, ImageType * quantized)
+{
+  typename TIntegerImage::Pointer integerImage = TIntegerImage::New();
+  integerImage->CopyInformation(input);
+  integerImage->SetRegions(input->GetBufferedRegion());
+  integerImage->Allocate();
+  quantized->CopyInformation(input);
+  quantized->SetRegions(input->GetBufferedRegion());
+  quantized->Allocate();
+
+  itk::ImageRegionConstIterator<ImageType> inputIt(input, input->GetBufferedRegion());
+  itk::ImageRegionIterator<TIntegerImage>  integerIt(integerImage, input->GetBufferedRegion());
+  itk::ImageRegionIterator<ImageType>      quantizedIt(quantized, input->GetBufferedRegion());
+  for (; !inputIt.IsAtEnd(); ++inputIt, ++integerIt, ++quantizedIt)
+  {
+    const auto value = static_cast<typename TIntegerImage::PixelType>(std::round(100.0 * inputIt.Get() + 100.0));
+    integerIt.Set(value);
+    quantizedIt.Set(static_cast<PixelType>(value));
+  }
+  return integerImage;
+}
+
+
+bool
+CheckDifference(const char * mode, const ImageType * reference, const ImageType * output, double tolerance)
+{
+  const double difference = MaximumAbsoluteDifference(reference, output);
+  std::cout << mode << ": maximum absolute difference " << difference << std::endl;
+  if (difference > tolerance)
+  {
+    std::cerr << mode << " differs from the default execution by " << difference << ", more than " << tolerance
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+// Prints the error of a reduced precision output against the full precision
+// reference, over the pixels where the reference is finite
+void
+ReportAccuracy(const char * mode, const ImageType * reference, const ImageType * output)
+{
+  using IteratorType = itk::ImageRegionConstIterator<ImageType>;
+  IteratorType referenceIt(reference, reference->GetBufferedRegion());
+  IteratorType outputIt(output, output->GetBufferedRegion());
+  double       maximumError = 0.0;
+  double       sumOfErrors = 0.0;
+  double       sumOfSquaredErrors = 0.0;
+  double       maximumRelativeError = 0.0;
+  std::size_t  count = 0;
+  for (; !referenceIt.IsAtEnd(); ++referenceIt, ++outputIt)
+  {
+    const double referenceValue = referenceIt.Get();
+    if (referenceValue > 1.0)
+    {
+      continue;
+    }
+    const double error = std::abs(static_cast<double>(outputIt.Get()) - referenceValue);
+    maximumError = std::max(maximumError, error);
+    sumOfErrors += error;
+    sumOfSquaredErrors += error * error;
+    if (referenceValue > 1e-3)
+    {
+      maximumRelativeError = std::max(maximumRelativeError, error / referenceValue);
+    }
+    ++count;
+  }
+  std::cout << mode << " accuracy against full precision over " << count << " pixels:" << std::endl;
+  std::cout << "  maximum absolute error " << maximumError << std::endl;
+  std::cout << "  mean absolute error " << (count ? sumOfErrors / count : 0.0) << std::endl;
+  std::cout << "  root mean square error " << (count ? std::sqrt(sumOfSquaredErrors / count) : 0.0) << std::endl;
+  std::cout << "  maximum relative error " << maximumRelativeError << std::endl;
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryImageFilterExecutionModesTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <CheckpointFile>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ImageType::SizeType inputSize;
+  inputSize.Fill(32);
+  ImageType::Pointer input = MakeInput<ImageType>(inputSize);
+
+  FilterType::Pointer referenceFilter = MakeFilter(input);
+  ImageType::Pointer  reference;
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference = RunFilter(referenceFilter));
+
+  bool success = true;
+
+  // Cost estimates
+  const ImageType::SizeType          size = input->GetLargestPossibleRegion().GetSize();
+  const FilterType::CostEstimateType precomputedCost = referenceFilter->EstimateCost(size, true);
+  const FilterType::CostEstimateType factoredCost = referenceFilter->EstimateCost(size, false);
+  std::cout << "Precomputed bank: " << precomputedCost.PeakMemoryInBytes << " bytes, "
+            << precomputedCost.NumberOfForwardFFTs << " forward and " << precomputedCost.NumberOfInverseFFTs
+            << " inverse FFTs, " << precomputedCost.FloatingPointOperations << " flops" << std::endl;
+  std::cout << "Factored bank: " << factoredCost.PeakMemoryInBytes << " bytes" << std::endl;
+  ITK_TEST_EXPECT_EQUAL(precomputedCost.NumberOfForwardFFTs, 1u);
+  ITK_TEST_EXPECT_EQUAL(precomputedCost.NumberOfInverseFFTs, 12u);
+  ITK_TEST_EXPECT_TRUE(factoredCost.PeakMemoryInBytes < precomputedCost.PeakMemoryInBytes);
+  ITK_TEST_EXPECT_TRUE(referenceFilter->EstimateCost().PrecomputeFilterBank);
+
+  // Streamed output, from a source that generates only the requested region
+  SourceType::Pointer streamedSource = MakeSource<ImageType>(inputSize);
+  streamedSource->UpdateOutputInformation();
+  FilterType::Pointer streamedFilter = MakeFilter(streamedSource->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(streamedFilter->Initialize());
+  using StreamerType = itk::StreamingImageFilter<ImageType, ImageType>;
+  StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput(streamedFilter->GetOutput());
+  streamer->SetNumberOfStreamDivisions(4);
+  ITK_TRY_EXPECT_NO_EXCEPTION(streamer->Update());
+  success &= CheckDifference("Streamed output", reference, streamer->GetOutput(), 1e-6);
+
+  // Factored filter bank
+  FilterType::Pointer factoredFilter = MakeFilter(input);
+  factoredFilter->PrecomputeFilterBankOff();
+  ImageType::Pointer factored;
+  ITK_TRY_EXPECT_NO_EXCEPTION(factored = RunFilter(factoredFilter));
+  success &= CheckDifference("Factored filter bank", reference, factored, 1e-6);
+
+  // A memory budget that only fits the factored filter bank selects it
+  FilterType::Pointer budgetFilter = MakeFilter(input);
+  budgetFilter->SetMemoryBudget(factoredCost.PeakMemoryInBytes);
+  ITK_TEST_EXPECT_TRUE(!budgetFilter->EstimateCost().PrecomputeFilterBank);
+  ImageType::Pointer budgeted;
+  ITK_TRY_EXPECT_NO_EXCEPTION(budgeted = RunFilter(budgetFilter));
+  success &= CheckDifference("Memory budget", reference, budgeted, 1e-6);
+
+  // A memory budget that fits no strategy fails before any work is done
+  budgetFilter->SetMemoryBudget(factoredCost.PeakMemoryInBytes - 1);
+  ITK_TRY_EXPECT_EXCEPTION(budgetFilter->Initialize());
+
+  // Half precision filter bank
+  FilterType::Pointer halfFilter = MakeFilter(input);
+  halfFilter->HalfPrecisionFilterBankOn();
+  ITK_TEST_EXPECT_TRUE(halfFilter->EstimateCost().PeakMemoryInBytes < precomputedCost.PeakMemoryInBytes);
+  ImageType::Pointer half;
+  ITK_TRY_EXPECT_NO_EXCEPTION(half = RunFilter(halfFilter));
+  ReportAccuracy("Half precision filter bank", reference, half);
+  success &= CheckDifference("Half precision filter bank", reference, half, 5e-3);
+
+  // Explicit FFT backends. 32 is a power of two, so VNL can transform it.
+  FilterType::Pointer vnlFilter = MakeFilter(input);
+  vnlFilter->SetFFTBackend(FilterType::FFTBackendEnum::VNL);
+  ITK_TEST_SET_GET_VALUE(FilterType::FFTBackendEnum::VNL, vnlFilter->GetFFTBackend());
+  ImageType::Pointer vnl;
+  ITK_TRY_EXPECT_NO_EXCEPTION(vnl = RunFilter(vnlFilter));
+  success &= CheckDifference("VNL FFT backend", reference, vnl, 1e-4);
+
+  FilterType::Pointer autotuneFilter = MakeFilter(input);
+  autotuneFilter->SetFFTBackend(FilterType::FFTBackendEnum::Autotune);
+  ImageType::Pointer autotuned;
+  ITK_TRY_EXPECT_NO_EXCEPTION(autotuned = RunFilter(autotuneFilter));
+  success &= CheckDifference("Autotuned FFT backend", reference, autotuned, 1e-4);
+
+  // Integer input, converted as the forward FFT reads it
+  using IntegerImageType = itk::Image<short, Dimension>;
+  using IntegerFilterType = itk::PhaseSymmetryImageFilter<IntegerImageType, ImageType>;
+  ImageType::Pointer        quantizedInput = ImageType::New();
+  IntegerImageType::Pointer integerInput = QuantizeInput<IntegerImageType>(input, quantizedInput);
+  FilterType::Pointer       quantizedFilter = MakeFilter(quantizedInput.GetPointer());
+  ImageType::Pointer        quantizedReference;
+  ITK_TRY_EXPECT_NO_EXCEPTION(quantizedReference = RunFilter(quantizedFilter));
+  IntegerFilterType::Pointer integerFilter = MakeFilter<IntegerFilterType>(integerInput);
+  ImageType::Pointer         integerOutput;
+  ITK_TRY_EXPECT_NO_EXCEPTION(integerOutput = RunFilter(integerFilter));
+  success &= CheckDifference("Integer input", quantizedReference, integerOutput, 1e-6);
+
+  // Integer input of an odd size with the FFTW backend, converted into the
+  // spectrum, against the same values as floating point through the FFTW
+  // filter. The size has a factor VNL cannot transform.
+  if (itk::PhaseSymmetryFFTWTraits<FilterType::ComputePixelType>::Available::value)
+  {
+    ImageType::SizeType       oddSize = { { 31, 27, 9 } };
+    ImageType::Pointer        oddQuantizedInput = ImageType::New();
+    IntegerImageType::Pointer oddIntegerInput =
+      QuantizeInput<IntegerImageType>(MakeInput<ImageType>(oddSize), oddQuantizedInput);
+    FilterType::Pointer oddQuantizedFilter = MakeFilter(oddQuantizedInput.GetPointer());
+    oddQuantizedFilter->SetFFTBackend(FilterType::FFTBackendEnum::FFTW);
+    ImageType::Pointer oddQuantizedReference;
+    ITK_TRY_EXPECT_NO_EXCEPTION(oddQuantizedReference = RunFilter(oddQuantizedFilter));
+    IntegerFilterType::Pointer oddIntegerFilter = MakeFilter<IntegerFilterType>(oddIntegerInput);
+    oddIntegerFilter->SetFFTBackend(IntegerFilterType::FFTBackendEnum::FFTW);
+    ImageType::Pointer oddIntegerOutput;
+    ITK_TRY_EXPECT_NO_EXCEPTION(oddIntegerOutput = RunFilter(oddIntegerFilter));
+    success &= CheckDifference("Odd-size integer input, FFTW backend", oddQuantizedReference, oddIntegerOutput, 1e-5);
+  }
+
+  // Integer output, clamped and rescaled from [0, 1] by the final pass
+  using ByteImageType = itk::Image<unsigned char, Dimension>;
+  using ByteFilterType = itk::PhaseSymmetryImageFilter<ImageType, ByteImageType>;
+  ByteFilterType::Pointer byteFilter = MakeFilter<ByteFilterType>(input);
+  ByteImageType::Pointer  byteOutput;
+  ITK_TRY_EXPECT_NO_EXCEPTION(byteOutput = RunFilter(byteFilter));
+  itk::ImageRegionConstIterator<ImageType>     referenceIt(reference, reference->GetBufferedRegion());
+  itk::ImageRegionConstIterator<ByteImageType> byteIt(byteOutput, byteOutput->GetBufferedRegion());
+  double                                       byteDifference = 0.0;
+  for (; !referenceIt.IsAtEnd(); ++referenceIt, ++byteIt)
+  {
+    const double expected = 255.0 * std::min(std::max(static_cast<double>(referenceIt.Get()), 0.0), 1.0);
+    byteDifference = std::max(byteDifference, std::abs(expected - byteIt.Get()));
+  }
+  std::cout << "Integer output: maximum absolute difference " << byteDifference << std::endl;
+  if (byteDifference > 0.51)
+  {
+    std::cerr << "Integer output differs from the rescaled default execution by " << byteDifference << std::endl;
+    success = false;
+  }
+
+  // A 32 bit integer output, whose maximum float cannot represent, reaches
+  // its maximum without overflowing
+  using UInt32ImageType = itk::Image<uint32_t, Dimension>;
+  using UInt32FilterType = itk::PhaseSymmetryImageFilter<ImageType, UInt32ImageType>;
+  UInt32FilterType::Pointer uint32Filter = MakeFilter<UInt32FilterType>(input);
+  UInt32ImageType::Pointer  uint32Output;
+  ITK_TRY_EXPECT_NO_EXCEPTION(uint32Output = RunFilter(uint32Filter));
+  const double                                   uint32Maximum = itk::NumericTraits<uint32_t>::max();
+  itk::ImageRegionConstIterator<UInt32ImageType> uint32It(uint32Output, uint32Output->GetBufferedRegion());
+  double                                         uint32Difference = 0.0;
+  for (referenceIt.GoToBegin(); !referenceIt.IsAtEnd(); ++referenceIt, ++uint32It)
+  {
+    const double clamped = std::min(std::max(static_cast<double>(referenceIt.Get()), 0.0), 1.0);
+    uint32Difference = std::max(uint32Difference, std::abs(clamped - uint32It.Get() / uint32Maximum));
+  }
+  std::cout << "32 bit integer output: maximum relative difference " << uint32Difference << std::endl;
+  ITK_TEST_EXPECT_EQUAL(UInt32FilterType::ConvertToOutputPixel(1.0f), itk::NumericTraits<uint32_t>::max());
+  ITK_TEST_EXPECT_EQUAL(UInt32FilterType::ConvertToOutputPixel(2.0f), itk::NumericTraits<uint32_t>::max());
+  ITK_TEST_EXPECT_EQUAL(UInt32FilterType::ConvertToOutputPixel(-1.0f), 0u);
+  if (uint32Difference > 1e-6)
+  {
+    std::cerr << "32 bit integer output differs from the rescaled default execution by " << uint32Difference
+              << std::endl;
+    success = false;
+  }
+
+  // A run stopped after its first orientation leaves a checkpoint, from which
+  // a second run with the same input and parameters resumes
+  const char *        checkpointFileName = argv[1];
+  FilterType::Pointer interruptedFilter = MakeFilter(input);
+  interruptedFilter->SetCheckpointFileName(checkpointFileName);
+  ITK_TEST_SET_GET_VALUE(std::string(checkpointFileName), std::string(interruptedFilter->GetCheckpointFileName()));
+  interruptedFilter->SetCheckpointInterval(1);
+  ITK_TEST_SET_GET_VALUE(1u, interruptedFilter->GetCheckpointInterval());
+  interruptedFilter->AddObserver(itk::IterationEvent(),
+                                 [](const itk::EventObject &) { throw itk::ProcessAborted(__FILE__, __LINE__); });
+  ITK_TRY_EXPECT_EXCEPTION(RunFilter(interruptedFilter));
+  ITK_TEST_EXPECT_TRUE(std::ifstream(checkpointFileName).good());
+
+  FilterType::Pointer resumedFilter = MakeFilter(input);
+  resumedFilter->SetCheckpointFileName(checkpointFileName);
+  ImageType::Pointer resumed;
+  ITK_TRY_EXPECT_NO_EXCEPTION(resumed = RunFilter(resumedFilter));
+  ITK_TEST_EXPECT_EQUAL(resumedFilter->GetNumberOfResumedOrientations(), 1u);
+  ITK_TEST_EXPECT_TRUE(!std::ifstream(checkpointFileName).good());
+  success &= CheckDifference("Resumed from a checkpoint", reference, resumed, 1e-6);
+
+  // The same pixels with another spacing do not resume that checkpoint
+  FilterType::Pointer reinterruptedFilter = MakeFilter(input);
+  reinterruptedFilter->SetCheckpointFileName(checkpointFileName);
+  reinterruptedFilter->SetCheckpointInterval(1);
+  reinterruptedFilter->AddObserver(itk::IterationEvent(),
+                                   [](const itk::EventObject &) { throw itk::ProcessAborted(__FILE__, __LINE__); });
+  ITK_TRY_EXPECT_EXCEPTION(RunFilter(reinterruptedFilter));
+  ITK_TEST_EXPECT_TRUE(std::ifstream(checkpointFileName).good());
+  ImageType::Pointer resampled = ImageType::New();
+  resampled->Graft(input);
+  ImageType::SpacingType resampledSpacing;
+  resampledSpacing.Fill(2.0);
+  resampled->SetSpacing(resampledSpacing);
+  FilterType::Pointer resampledFilter = MakeFilter(resampled.GetPointer());
+  resampledFilter->SetCheckpointFileName(checkpointFileName);
+  ITK_TRY_EXPECT_NO_EXCEPTION(RunFilter(resampledFilter));
+  ITK_TEST_EXPECT_EQUAL(resampledFilter->GetNumberOfResumedOrientations(), 0u);
+
+  // Opposite orientations share their inverse FFTs. On an odd size the bank
+  // is exactly symmetric, so that the shared responses match those computed
+  // apart. (-1, 1e-300, 0) is not exactly opposite to (1, 0, 0), but has the
+  // same filter bank entries as (-1, 0, 0).
+  ImageType::SizeType oddSize = { { 27, 25, 15 } };
+  ImageType::Pointer  oddInput = MakeInput<ImageType>(oddSize);
+
+  FilterType::MatrixType apartOrientations(4, Dimension);
+  apartOrientations.fill(0.0);
+  apartOrientations(0, 0) = 1.0;
+  apartOrientations(1, 1) = 1.0;
+  apartOrientations(2, 2) = 1.0;
+  apartOrientations(3, 0) = -1.0;
+  apartOrientations(3, 1) = 1e-300;
+  FilterType::MatrixType oppositeOrientations = apartOrientations;
+  oppositeOrientations(3, 1) = 0.0;
+
+  FilterType::Pointer apartFilter = MakeFilter(oddInput);
+  apartFilter->SetOrientations(apartOrientations);
+  ImageType::Pointer apart;
+  ITK_TRY_EXPECT_NO_EXCEPTION(apart = RunFilter(apartFilter));
+  ITK_TEST_EXPECT_EQUAL(apartFilter->GetNumberOfDistinctOrientations(), 4u);
+
+  FilterType::Pointer oppositeFilter = MakeFilter(oddInput);
+  oppositeFilter->SetOrientations(oppositeOrientations);
+  ITK_TEST_EXPECT_EQUAL(oppositeFilter->EstimateCost(oddSize, true).NumberOfInverseFFTs, 12u);
+  ImageType::Pointer opposite;
+  ITK_TRY_EXPECT_NO_EXCEPTION(opposite = RunFilter(oppositeFilter));
+  ITK_TEST_EXPECT_EQUAL(oppositeFilter->GetNumberOfDistinctOrientations(), 3u);
+  ITK_TEST_EXPECT_EQUAL(oppositeFilter->GetOrientationMultiplicity(0), 2u);
+  success &= CheckDifference("Opposite orientations", apart, opposite, 1e-4);
+
+  // Folded onto a half-sphere, the orientations opposite up to rounding
+  // share their responses as well
+  FilterType::Pointer canonicalFilter = MakeFilter(oddInput);
+  canonicalFilter->SetOrientations(apartOrientations);
+  canonicalFilter->CanonicalizeOrientationsOn();
+  ITK_TEST_SET_GET_VALUE(true, canonicalFilter->GetCanonicalizeOrientations());
+  ImageType::Pointer canonical;
+  ITK_TRY_EXPECT_NO_EXCEPTION(canonical = RunFilter(canonicalFilter));
+  ITK_TEST_EXPECT_EQUAL(canonicalFilter->GetNumberOfDistinctOrientations(), 3u);
+  success &= CheckDifference("Canonical orientations", apart, canonical, 1e-4);
+
+  // A decimated preview is computed at half the resolution, with the
+  // geometry of every second input pixel. Wavelengths long enough for the
+  // band-passed spectra to fit below the output Nyquist frequency make it
+  // close to the full resolution result sampled every second pixel.
+  FilterType::MatrixType longWavelengths(2, Dimension);
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+  {
+    longWavelengths(0, dim) = 16.0;
+    longWavelengths(1, dim) = 24.0;
+  }
+  FilterType::Pointer fullResolutionFilter = MakeFilter(input);
+  fullResolutionFilter->SetWavelengths(longWavelengths);
+  ImageType::Pointer fullResolution;
+  ITK_TRY_EXPECT_NO_EXCEPTION(fullResolution = RunFilter(fullResolutionFilter));
+
+  FilterType::Pointer decimatedFilter = MakeFilter(input);
+  decimatedFilter->SetWavelengths(longWavelengths);
+  decimatedFilter->SetDecimationFactor(2);
+  ITK_TEST_SET_GET_VALUE(2u, decimatedFilter->GetDecimationFactor());
+  ITK_TEST_EXPECT_TRUE(decimatedFilter->EstimateCost().PeakMemoryInBytes <
+                       fullResolutionFilter->EstimateCost().PeakMemoryInBytes);
+  ImageType::Pointer decimated;
+  ITK_TRY_EXPECT_NO_EXCEPTION(decimated = RunFilter(decimatedFilter));
+
+  ImageType::SizeType decimatedSize;
+  decimatedSize.Fill(16);
+  ITK_TEST_EXPECT_EQUAL(decimated->GetLargestPossibleRegion().GetSize(), decimatedSize);
+  ITK_TEST_EXPECT_EQUAL(decimated->GetSpacing()[0], 2.0 * input->GetSpacing()[0]);
+  ITK_TEST_EXPECT_EQUAL(decimated->GetOrigin(), input->GetOrigin());
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> decimatedIt(decimated, decimated->GetBufferedRegion());
+  double                                            sumOfErrors = 0.0;
+  double                                            maximumError = 0.0;
+  std::size_t                                       count = 0;
+  for (; !decimatedIt.IsAtEnd(); ++decimatedIt)
+  {
+    ImageType::IndexType index = decimatedIt.GetIndex();
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      index[dim] *= 2;
+    }
+    const double expected = fullResolution->GetPixel(index);
+    if (expected > 1.0)
+    {
+      continue;
+    }
+    const double error = std::abs(static_cast<double>(decimatedIt.Get()) - expected);
+    sumOfErrors += error;
+    maximumError = std::max(maximumError, error);
+    ++count;
+  }
+  const double meanError = count ? sumOfErrors / count : 0.0;
+  std::cout << "Decimated preview: mean absolute error " << meanError << ", maximum " << maximumError << std::endl;
+  if (count == 0 || meanError > 0.02)
+  {
+    std::cerr << "Decimated preview differs from the sampled full resolution result by " << meanError
+              << " on average" << std::endl;
+    success = false;
+  }
+
+  // Progressive updates deliver a partial result after every scale or every
+  // orientation, and a final one that is the output, without changing it
+  const FilterType::ProgressiveUpdatesEnum progressiveModes[] = { FilterType::ProgressiveUpdatesEnum::PerOrientation,
+                                                                   FilterType::ProgressiveUpdatesEnum::PerScale };
+  for (const FilterType::ProgressiveUpdatesEnum mode : progressiveModes)
+  {
+    FilterType::Pointer progressiveFilter = MakeFilter(input);
+    progressiveFilter->SetProgressiveUpdates(mode);
+    ITK_TEST_SET_GET_VALUE(mode, progressiveFilter->GetProgressiveUpdates());
+
+    unsigned int numberOfPartialResults = 0;
+    unsigned int numberOfFinalResults = 0;
+    bool         partialResultsValid = true;
+    FilterType * progressive = progressiveFilter.GetPointer();
+    progressiveFilter->AddObserver(itk::PhaseSymmetryPartialResultEvent(), [&](const itk::EventObject & event) {
+      const ImageType * partialResult = progressive->GetPartialResult();
+      const bool        isFinal = static_cast<const itk::PhaseSymmetryPartialResultEvent &>(event).GetIsFinal();
+      ++numberOfPartialResults;
+      numberOfFinalResults += isFinal ? 1 : 0;
+      partialResultsValid = partialResultsValid && partialResult != nullptr &&
+                            partialResult->GetLargestPossibleRegion() == reference->GetLargestPossibleRegion() &&
+                            isFinal == (partialResult == progressive->GetOutput());
+    });
+    ImageType::Pointer progressiveOutput;
+    ITK_TRY_EXPECT_NO_EXCEPTION(progressiveOutput = RunFilter(progressiveFilter));
+    std::cout << "Progressive updates " << mode << ": " << numberOfPartialResults << " partial results" << std::endl;
+
+    const unsigned int expectedPartialResults = mode == FilterType::ProgressiveUpdatesEnum::PerScale
+                                                  ? 4 * progressiveFilter->GetNumberOfDistinctOrientations()
+                                                  : progressiveFilter->GetNumberOfDistinctOrientations();
+    ITK_TEST_EXPECT_EQUAL(numberOfPartialResults, expectedPartialResults);
+    ITK_TEST_EXPECT_EQUAL(numberOfFinalResults, 1u);
+    ITK_TEST_EXPECT_TRUE(partialResultsValid);
+    ITK_TEST_EXPECT_TRUE(progressiveFilter->GetPartialResult() == nullptr);
+    success &= CheckDifference("Progressive updates", reference, progressiveOutput, 1e-6);
+  }
+
+  // Slice-wise mode processes the slices orthogonal to the slice axis as 2D
+  // images, with the wavelengths of the other axes and the orientations that
+  // have a component along them, and only the slices of the requested region.
+  // It matches a 2D filter run on each slice.
+  using SliceImageType = itk::Image<PixelType, 2>;
+  using SliceFilterType = itk::PhaseSymmetryImageFilter<SliceImageType, SliceImageType>;
+  for (const unsigned int axis : { 2u, 0u })
+  {
+    FilterType::Pointer sliceWiseFilter = MakeFilter(input);
+    sliceWiseFilter->SliceWiseOn();
+    sliceWiseFilter->SetSliceAxis(axis);
+    ITK_TEST_SET_GET_VALUE(axis, sliceWiseFilter->GetSliceAxis());
+    ITK_TRY_EXPECT_NO_EXCEPTION(sliceWiseFilter->Initialize());
+    ITK_TEST_EXPECT_TRUE(sliceWiseFilter->GetPlan() == nullptr);
+    ITK_TEST_EXPECT_EQUAL(sliceWiseFilter->GetSliceFilter()->GetNumberOfDistinctOrientations(), 2u);
+
+    ImageType::RegionType requestedRegion = input->GetLargestPossibleRegion();
+    requestedRegion.SetIndex(axis, 8);
+    requestedRegion.SetSize(axis, 4);
+    sliceWiseFilter->UpdateOutputInformation();
+    sliceWiseFilter->GetOutput()->SetRequestedRegion(requestedRegion);
+    ITK_TRY_EXPECT_NO_EXCEPTION(sliceWiseFilter->GetOutput()->Update());
+    const ImageType * sliceWiseOutput = sliceWiseFilter->GetOutput();
+    ITK_TEST_EXPECT_TRUE(sliceWiseOutput->GetBufferedRegion() == requestedRegion);
+
+    unsigned int axes[2];
+    for (unsigned int i = 0, j = 0; i < Dimension; ++i)
+    {
+      if (i != axis)
+      {
+        axes[j++] = i;
+      }
+    }
+    SliceImageType::SizeType sliceSize;
+    sliceSize[0] = inputSize[axes[0]];
+    sliceSize[1] = inputSize[axes[1]];
+
+    double difference = 0.0;
+    for (itk::IndexValueType slice = 8; slice < 12; ++slice)
+    {
+      SliceImageType::Pointer sliceInput = SliceImageType::New();
+      sliceInput->SetRegions(sliceSize);
+      sliceInput->Allocate();
+      ImageType::IndexType index;
+      index[axis] = slice;
+      itk::ImageRegionIteratorWithIndex<SliceImageType> sliceIt(sliceInput, sliceInput->GetLargestPossibleRegion());
+      for (; !sliceIt.IsAtEnd(); ++sliceIt)
+      {
+        index[axes[0]] = sliceIt.GetIndex()[0];
+        index[axes[1]] = sliceIt.GetIndex()[1];
+        sliceIt.Set(input->GetPixel(index));
+      }
+
+      SliceFilterType::Pointer sliceFilter = SliceFilterType::New();
+      sliceFilter->SetInput(sliceInput);
+      sliceFilter->SetPolarity(1);
+      sliceFilter->SetNoiseThreshold(2.0);
+      sliceFilter->SetSigma(0.55);
+      sliceFilter->SetFFTBackend(SliceFilterType::FFTBackendEnum::VNL);
+      SliceFilterType::MatrixType sliceWavelengths(4, 2);
+      for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+        sliceWavelengths(0, dim) = 4.0;
+        sliceWavelengths(1, dim) = 8.0;
+        sliceWavelengths(2, dim) = 12.0;
+        sliceWavelengths(3, dim) = 16.0;
+      }
+      sliceFilter->SetWavelengths(sliceWavelengths);
+      SliceImageType::Pointer sliceReference;
+      ITK_TRY_EXPECT_NO_EXCEPTION(sliceReference = RunFilter(sliceFilter));
+
+      itk::ImageRegionConstIteratorWithIndex<SliceImageType> referenceIt(sliceReference,
+                                                                         sliceReference->GetLargestPossibleRegion());
+      for (; !referenceIt.IsAtEnd(); ++referenceIt)
+      {
+        index[axes[0]] = referenceIt.GetIndex()[0];
+        index[axes[1]] = referenceIt.GetIndex()[1];
+        difference = std::max(difference, double(std::abs(referenceIt.Get() - sliceWiseOutput->GetPixel(index))));
+      }
+    }
+    std::cout << "Slice-wise along axis " << axis << ": maximum absolute difference " << difference << std::endl;
+    if (!(difference <= 1e-5))
+    {
+      std::cerr << "Slice-wise output along axis " << axis << " differs from the 2D filter by " << difference
+                << std::endl;
+      success = false;
+    }
+  }
+
+  // Orientations along the slice axis only leave no orientation in the slices
+  FilterType::Pointer    alongAxisFilter = MakeFilter(input);
+  FilterType::MatrixType alongAxis(1, Dimension, 0.0);
+  alongAxis(0, 2) = 1.0;
+  alongAxisFilter->SetOrientations(alongAxis);
+  alongAxisFilter->SliceWiseOn();
+  ITK_TRY_EXPECT_EXCEPTION(alongAxisFilter->Initialize());
+
+  if (!success)
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryImageFilter.h"
+#include "itkLogGaborFreqImageSource.h"
+#include "itkButterworthFilterFreqImageSource.h"
+#include "itkSteerableFilterFreqImageSource.h"
+#include "itkSinusoidImageSource.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#  include <sys/resource.h>
+#endif
+
+// Performance regression test. Each invocation runs one named workload in its
+// own process, and measures its wall clock time normalised by a fixed
+// calibration loop, and the increase of the peak resident memory of the
+// process over its peak before the workload. The measurement is compared
+// against the entry of the same name in the baseline file; a workload
+// without an entry is reported as skipped, with SkipReturnCode.
+//
+// Baseline file format, one workload per line, '#' starts a comment:
+//
+//   <Workload> <NormalizedTime> <PeakMemoryInMB>
+//
+// The test prints its own measurement in this format, so a baseline is
+// refreshed by copying the "Measured:" line of a run on the reference host.
+
+namespace
+{
+
+constexpr unsigned int PerformanceRepeats = 3;
+
+// The SKIP_RETURN_CODE of the tests in test/CMakeLists.txt.
+constexpr int SkipReturnCode = 77;
+
+// Keeps the calibration loop from being optimized away.
+volatile double calibrationChecksum = 0.0;
+
+template <typename TImage>
+typename TImage::Pointer
+MakeSinusoidImage(typename TImage::SizeValueType edge)
+{
+  using SourceType = itk::SinusoidImageSource<TImage>;
+  typename SourceType::Pointer source = SourceType::New();
+
+  typename TImage::SizeType size;
+  size.Fill(edge);
+  source->SetSize(size);
+  typename SourceType::ArrayType frequency;
+  for (unsigned int ii = 0; ii < TImage::ImageDimension; ++ii)
+  {
+    frequency[ii] = 0.03 * (ii + 1);
+  }
+  source->SetFrequency(frequency);
+  source->SetPhaseOffset(0.2);
+  source->Update();
+
+  typename TImage::Pointer image = source->GetOutput();
+  image->DisconnectPipeline();
+  return image;
+}
+
+
+template <unsigned int VDimension>
+void
+RunPhaseSymmetry(itk::SizeValueType edge)
+{
+  using ImageType = itk::Image<float, VDimension>;
+  typename ImageType::Pointer input = MakeSinusoidImage<ImageType>(edge);
+
+  using FilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(input);
+  typename FilterType::MatrixType wavelengths(3, VDimension);
+  for (unsigned int dim = 0; dim < VDimension; ++dim)
+  {
+    wavelengths(0, dim) = 10.0;
+    wavelengths(1, dim) = 20.0;
+    wavelengths(2, dim) = 30.0;
+  }
+  filter->SetWavelengths(wavelengths);
+  filter->Initialize();
+  filter->Update();
+}
+
+
+template <typename TSource>
+void
+RunKernelSource(typename TSource::Pointer source, itk::SizeValueType edge)
+{
+  typename TSource::SizeType size;
+  size.Fill(edge);
+  source->SetSize(size);
+  source->Update();
+}
+
+
+bool
+RunWorkload(const std::string & workload)
+{
+  using ImageType = itk::Image<float, 3>;
+  constexpr itk::SizeValueType kernelEdge = 128;
+
+  if (workload == "PhaseSymmetry2D")
+  {
+    RunPhaseSymmetry<2>(512);
+  }
+  else if (workload == "PhaseSymmetry3D")
+  {
+    RunPhaseSymmetry<3>(64);
+  }
+  else if (workload == "LogGaborFreqImageSource")
+  {
+    using SourceType = itk::LogGaborFreqImageSource<ImageType>;
+    SourceType::Pointer   source = SourceType::New();
+    SourceType::ArrayType wavelengths;
+    wavelengths.Fill(10.0);
+    source->SetWavelengths(wavelengths);
+    source->SetSigma(0.55);
+    RunKernelSource<SourceType>(source, kernelEdge);
+  }
+  else if (workload == "ButterworthFilterFreqImageSource")
+  {
+    using SourceType = itk::ButterworthFilterFreqImageSource<ImageType>;
+    SourceType::Pointer source = SourceType::New();
+    source->SetCutoff(0.4);
+    source->SetOrder(10.0);
+    RunKernelSource<SourceType>(source, kernelEdge);
+  }
+  else if (workload == "SteerableFilterFreqImageSource")
+  {
+    using SourceType = itk::SteerableFilterFreqImageSource<ImageType>;
+    SourceType::Pointer         source = SourceType::New();
+    SourceType::DoubleArrayType orientation;
+    orientation.Fill(0.0);
+    orientation[0] = 1.0;
+    source->SetOrientation(orientation);
+    source->SetAngularBandwidth(3.14159265);
+    RunKernelSource<SourceType>(source, kernelEdge);
+  }
+  else if (workload == "SinusoidImageSource")
+  {
+    MakeSinusoidImage<ImageType>(kernelEdge);
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+
+// A fixed amount of arithmetic and memory traffic that does not depend on
+// this module. Workload times are expressed in units of this loop so that
+// baselines can be compared across hosts of different speed.
+double
+RunCalibration()
+{
+  std::vector<float> buffer(1 << 22);
+  double             checksum = 0.0;
+  for (unsigned int pass = 0; pass < 8; ++pass)
+  {
+    for (std::size_t ii = 0; ii < buffer.size(); ++ii)
+    {
+      buffer[ii] = std::sqrt(static_cast<float>(ii + pass)) * 0.5f + buffer[ii] * 0.25f;
+    }
+    for (std::size_t ii = 0; ii < buffer.size(); ii += 16)
+    {
+      checksum += buffer[ii];
+    }
+  }
+  return checksum;
+}
+
+
+double
+PeakMemoryInMB()
+{
+#if !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+  {
+    return 0.0;
+  }
+#  if defined(__APPLE__)
+  // Reported in bytes on macOS.
+  return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#  else
+  // Reported in kilobytes on Linux and the BSDs.
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#  endif
+#else
+  return 0.0;
+#endif
+}
+
+
+bool
+ReadBaseline(const std::string & fileName, const std::string & workload, double & time, double & memory)
+{
+  std::ifstream baselineFile(fileName.c_str());
+  if (!baselineFile)
+  {
+    return false;
+  }
+  std::string line;
+  while (std::getline(baselineFile, line))
+  {
+    const std::string::size_type comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line.erase(comment);
+    }
+    std::istringstream stream(line);
+    std::string        name;
+    double             baselineTime = 0.0;
+    double             baselineMemory = 0.0;
+    if (stream >> name >> baselineTime >> baselineMemory && name == workload)
+    {
+      time = baselineTime;
+      memory = baselineMemory;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryPerformanceTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " Workload BaselineFile [TimeTolerance] [MemoryTolerance] [FailOnRegression]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string workload = argv[1];
+  const std::string baselineFileName = argv[2];
+  double            timeTolerance = 0.5;
+  if (argc > 3)
+  {
+    timeTolerance = std::stod(argv[3]);
+  }
+  double memoryTolerance = 0.25;
+  if (argc > 4)
+  {
+    memoryTolerance = std::stod(argv[4]);
+  }
+  bool failOnRegression = false;
+  if (argc > 5)
+  {
+    failOnRegression = std::stoi(argv[5]) != 0;
+  }
+
+  double calibrationTime = std::numeric_limits<double>::max();
+  double workloadTime = std::numeric_limits<double>::max();
+  double peakMemory = 0.0;
+  try
+  {
+    // The first pass warms up caches, the object factories and any FFT plans.
+    // It runs before the calibration loop, so that the peak memory it adds to
+    // the watermark of the process before it is that of the workload alone;
+    // the later passes reach the same peak.
+    const double watermark = PeakMemoryInMB();
+    if (!RunWorkload(workload))
+    {
+      std::cerr << "Unknown workload: " << workload << std::endl;
+      return EXIT_FAILURE;
+    }
+    peakMemory = PeakMemoryInMB() - watermark;
+    for (unsigned int repeat = 0; repeat < PerformanceRepeats; ++repeat)
+    {
+      itk::TimeProbe calibrationProbe;
+      calibrationProbe.Start();
+      calibrationChecksum = RunCalibration();
+      calibrationProbe.Stop();
+      calibrationTime = std::min(calibrationTime, calibrationProbe.GetTotal());
+
+      itk::TimeProbe workloadProbe;
+      workloadProbe.Start();
+      RunWorkload(workload);
+      workloadProbe.Stop();
+      workloadTime = std::min(workloadTime, workloadProbe.GetTotal());
+    }
+  }
+  catch (itk::ExceptionObject & error)
+  {
+    std::cerr << "Error: " << error << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double normalizedTime = workloadTime / std::max(calibrationTime, 1e-9);
+
+  std::cout << "Workload time: " << workloadTime << " s, calibration time: " << calibrationTime << " s" << std::endl;
+  std::cout << "Measured: " << workload << " " << normalizedTime << " " << peakMemory << std::endl;
+
+  double baselineTime = 0.0;
+  double baselineMemory = 0.0;
+  if (!ReadBaseline(baselineFileName, workload, baselineTime, baselineMemory))
+  {
+    std::cout << "No baseline for " << workload << " in " << baselineFileName
+              << "; record the Measured line above on the reference host. Skipped." << std::endl;
+    return SkipReturnCode;
+  }
+  std::cout << "Baseline: " << workload << " " << baselineTime << " " << baselineMemory << std::endl;
+
+  bool regressed = false;
+  if (normalizedTime > baselineTime * (1.0 + timeTolerance))
+  {
+    std::cout << "Normalized time " << normalizedTime << " exceeds the baseline " << baselineTime << " by more than "
+              << timeTolerance * 100.0 << "%." << std::endl;
+    regressed = true;
+  }
+  if (baselineMemory > 0.0 && peakMemory > baselineMemory * (1.0 + memoryTolerance))
+  {
+    std::cout << "Peak memory " << peakMemory << " MB exceeds the baseline " << baselineMemory << " MB by more than "
+              << memoryTolerance * 100.0 << "%." << std::endl;
+    regressed = true;
+  }
+
+  if (regressed)
+  {
+    if (failOnRegression)
+    {
+      std::cerr << "Performance regression in " << workload << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "WARNING: performance regression in " << workload << "." << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryImageFilter.h"
+#include "itkPhaseSymmetryTestHelpers.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Checks that a PhaseSymmetryPlan, executed concurrently from several
+// threads with one scratch each, reproduces PhaseSymmetryImageFilter for
+// every form of the filter bank, and that it survives a later Initialize().
+
+namespace
+{
+
+constexpr unsigned int Dimension = 2;
+using PixelType = float;
+using ImageType = itk::Image<PixelType, Dimension>;
+using FilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
+using PlanType = FilterType::PlanType;
+
+using PhaseSymmetryTestHelpers::MakeInput;
+using PhaseSymmetryTestHelpers::MaximumAbsoluteDifference;
+
+// The VNL backend, whose transforms the plan carries out, and orientations
+// of which two are opposite
+FilterType::Pointer
+MakeFilter(const ImageType * input)
+{
+  FilterType::Pointer filter = PhaseSymmetryTestHelpers::MakeFilter<FilterType>(input);
+  filter->SetFFTBackend(FilterType::FFTBackendEnum::VNL);
+  FilterType::MatrixType orientations(3, Dimension);
+  orientations(0, 0) = 1.0;
+  orientations(0, 1) = 0.0;
+  orientations(1, 0) = 0.0;
+  orientations(1, 1) = 1.0;
+  orientations(2, 0) = -1.0;
+  orientations(2, 1) = 0.0;
+  filter->SetOrientations(orientations);
+  return filter;
+}
+
+
+// Run a plan from several threads at once, each with its own scratch and
+// several times over, and return the largest difference from the reference
+double
+ExecuteConcurrently(const PlanType * plan, const ImageType * input, const ImageType * reference)
+{
+  constexpr unsigned int numberOfThreads = 4;
+  constexpr unsigned int numberOfRuns = 3;
+
+  const std::size_t                   count = input->GetLargestPossibleRegion().GetNumberOfPixels();
+  std::vector<std::vector<PixelType>> results(numberOfThreads, std::vector<PixelType>(count));
+  std::vector<double>                 differences(numberOfThreads, 0.0);
+  std::vector<std::thread>            threads;
+  for (unsigned int t = 0; t < numberOfThreads; ++t)
+  {
+    threads.emplace_back([plan, input, reference, t, &results, &differences]() {
+      PlanType::ScratchType scratch;
+      for (unsigned int run = 0; run < numberOfRuns; ++run)
+      {
+        plan->Execute(input->GetBufferPointer(), results[t].data(), scratch);
+        differences[t] = std::max(differences[t], MaximumAbsoluteDifference(reference, results[t]));
+      }
+    });
+  }
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+  return *std::max_element(differences.begin(), differences.end());
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryPlanTest(int, char *[])
+{
+  constexpr double tolerance = 1e-5;
+  bool             success = true;
+
+  ImageType::SizeType size;
+  size[0] = 60;
+  size[1] = 48;
+  ImageType::Pointer input = MakeInput<ImageType>(size);
+
+  FilterType::Pointer filter = MakeFilter(input);
+  ITK_TEST_EXPECT_TRUE(filter->GetPlan() == nullptr);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Initialize());
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ImageType::Pointer reference = filter->GetOutput();
+  reference->DisconnectPipeline();
+
+  PlanType::ConstPointer plan = filter->GetPlan();
+  ITK_TEST_EXPECT_TRUE(plan.IsNotNull());
+  plan->Print(std::cout);
+  ITK_TEST_EXPECT_TRUE(plan->IsSizeSupported());
+  ITK_TEST_EXPECT_EQUAL(plan->GetNumberOfScales(), 3u);
+  ITK_TEST_EXPECT_EQUAL(plan->GetNumberOfDistinctOrientations(), 2u);
+
+  double difference = ExecuteConcurrently(plan, input, reference);
+  std::cout << "Concurrent execution: maximum absolute difference " << difference << std::endl;
+  success &= difference <= tolerance;
+
+  // A later Initialize() with other parameters builds a new plan and leaves
+  // the shared one intact
+  filter->SetNoiseThreshold(0.5);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Initialize());
+  ITK_TEST_EXPECT_TRUE(filter->GetPlan() != plan.GetPointer());
+  difference = ExecuteConcurrently(plan, input, reference);
+  std::cout << "Previous plan after Initialize(): maximum absolute difference " << difference << std::endl;
+  success &= difference <= tolerance;
+
+  // The factored and the half precision filter banks
+  for (unsigned int mode = 0; mode < 2; ++mode)
+  {
+    FilterType::Pointer bankFilter = MakeFilter(input);
+    bankFilter->SetPrecomputeFilterBank(mode != 0);
+    bankFilter->SetHalfPrecisionFilterBank(mode != 0);
+    ITK_TRY_EXPECT_NO_EXCEPTION(bankFilter->Initialize());
+    ITK_TRY_EXPECT_NO_EXCEPTION(bankFilter->Update());
+    difference = ExecuteConcurrently(bankFilter->GetPlan(), input, bankFilter->GetOutput());
+    std::cout << (mode == 0 ? "Factored" : "Half precision")
+              << " filter bank: maximum absolute difference " << difference << std::endl;
+    success &= difference <= tolerance;
+  }
+
+  // The VNL transforms of a plan need sizes with prime factors 2, 3 and 5
+  ImageType::SizeType oddSize;
+  oddSize.Fill(7);
+  FilterType::Pointer oddFilter = MakeFilter(MakeInput<ImageType>(oddSize));
+  oddFilter->SetFFTBackend(FilterType::FFTBackendEnum::Default);
+  ITK_TRY_EXPECT_NO_EXCEPTION(oddFilter->Initialize());
+  ITK_TEST_EXPECT_TRUE(!oddFilter->GetPlan()->IsSizeSupported());
+  PlanType::ScratchType scratch;
+  ITK_TRY_EXPECT_EXCEPTION(oddFilter->GetPlan()->AllocateScratch(scratch));
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryImageFilter.h"
+#include "itkPhaseSymmetryTestHelpers.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <spawn.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+extern char ** environ;
+#endif
+
+// Checks that a PhaseSymmetryImageFilter job sharded over several local
+// processes, which this test launches again through the test driver, gives
+// every shard the result of the whole job run in one process.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 2;
+constexpr unsigned int NumberOfShards = 4;
+using PixelType = float;
+using ImageType = itk::Image<PixelType, Dimension>;
+using FilterType = itk::PhaseSymmetryImageFilter<ImageType, ImageType>;
+
+using PhaseSymmetryTestHelpers::MaximumAbsoluteDifference;
+using PhaseSymmetryTestHelpers::RunFilter;
+
+ImageType::Pointer
+MakeInput()
+{
+  ImageType::SizeType size = { { 60, 48 } };
+  return PhaseSymmetryTestHelpers::MakeInput<ImageType>(size);
+}
+
+
+// Three scales and three orientations, whose nine entries split unevenly
+// between the shards, so that some orientations span two shards
+FilterType::Pointer
+MakeFilter(const ImageType * input)
+{
+  FilterType::Pointer    filter = PhaseSymmetryTestHelpers::MakeFilter<FilterType>(input);
+  FilterType::MatrixType orientations(3, Dimension);
+  orientations(0, 0) = 1.0;
+  orientations(0, 1) = 0.0;
+  orientations(1, 0) = 0.0;
+  orientations(1, 1) = 1.0;
+  orientations(2, 0) = 1.0;
+  orientations(2, 1) = 1.0;
+  filter->SetOrientations(orientations);
+  return filter;
+}
+
+
+// Run one shard of the job and compare its output with the reference
+bool
+RunShard(const ImageType *   input,
+         const ImageType *   reference,
+         const std::string & name,
+         uint64_t            runIdentifier,
+         unsigned int        shardIndex)
+{
+  FilterType::Pointer filter = MakeFilter(input);
+  filter->SetNumberOfShards(NumberOfShards);
+  filter->SetShardIndex(shardIndex);
+  filter->SetSharedMemoryName(name);
+  filter->SetShardRunIdentifier(runIdentifier);
+  filter->SetShardTimeout(60.0);
+
+  ImageType::Pointer output;
+  try
+  {
+    output = RunFilter(filter);
+  }
+  catch (const itk::ExceptionObject & error)
+  {
+    std::cerr << "Shard " << shardIndex << " failed: " << error << std::endl;
+    return false;
+  }
+
+  const double difference = MaximumAbsoluteDifference(reference, output);
+  std::cout << "Shard " << shardIndex << ": " << filter->EstimateCost().NumberOfInverseFFTs
+            << " inverse FFTs, maximum absolute difference " << difference << std::endl;
+  if (difference > 1e-4)
+  {
+    std::cerr << "Shard " << shardIndex << " differs from the whole job by " << difference << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryShardingTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <TestDriver> [<SharedMemoryName> <RunIdentifier> <ShardIndex>]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+#if defined(_WIN32)
+  std::cout << "Shared memory shards require POSIX shared memory; skipped." << std::endl;
+  return EXIT_SUCCESS;
+#else
+  ImageType::Pointer  input = MakeInput();
+  FilterType::Pointer referenceFilter = MakeFilter(input);
+  ImageType::Pointer  reference;
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference = RunFilter(referenceFilter));
+
+  // A worker process, launched below
+  if (argc >= 5)
+  {
+    const bool success =
+      RunShard(input, reference, argv[2], std::stoull(argv[3]), static_cast<unsigned int>(std::stoul(argv[4])));
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  const std::string name = "/itkPhaseSymmetryShardingTest-" + std::to_string(getpid());
+  const uint64_t    runIdentifier =
+    (static_cast<uint64_t>(getpid()) << 32) ^
+    static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+
+  // Inconsistent shard settings fail before any work is done
+  FilterType::Pointer invalidFilter = MakeFilter(input);
+  invalidFilter->SetNumberOfShards(2);
+  ITK_TEST_SET_GET_VALUE(2u, invalidFilter->GetNumberOfShards());
+  invalidFilter->SetShardIndex(2);
+  ITK_TEST_SET_GET_VALUE(2u, invalidFilter->GetShardIndex());
+  invalidFilter->SetSharedMemoryName(name);
+  ITK_TEST_SET_GET_VALUE(name, std::string(invalidFilter->GetSharedMemoryName()));
+  ITK_TRY_EXPECT_EXCEPTION(RunFilter(invalidFilter));
+  invalidFilter->SetShardIndex(0);
+  invalidFilter->SetSharedMemoryName("");
+  ITK_TRY_EXPECT_EXCEPTION(RunFilter(invalidFilter));
+  invalidFilter->SetSharedMemoryName(name);
+  ITK_TEST_SET_GET_VALUE(0u, invalidFilter->GetShardRunIdentifier());
+  ITK_TRY_EXPECT_EXCEPTION(RunFilter(invalidFilter));
+
+  // A shard whose peers never come times out, and removes the name of the
+  // shared memory it created
+  FilterType::Pointer aloneFilter = MakeFilter(input);
+  aloneFilter->SetNumberOfShards(2);
+  aloneFilter->SetSharedMemoryName(name);
+  aloneFilter->SetShardRunIdentifier(runIdentifier);
+  ITK_TEST_SET_GET_VALUE(runIdentifier, aloneFilter->GetShardRunIdentifier());
+  aloneFilter->SetShardTimeout(0.5);
+  ITK_TEST_SET_GET_VALUE(0.5, aloneFilter->GetShardTimeout());
+  ITK_TRY_EXPECT_EXCEPTION(RunFilter(aloneFilter));
+  ITK_TEST_EXPECT_TRUE(shm_open(name.c_str(), O_RDWR, 0) < 0);
+
+  // A shard does not attach to a segment that a failed run left under the
+  // name, and attaches once the first shard of its run has replaced it
+  {
+    using SharedMemoryType = itk::PhaseSymmetrySharedMemory;
+    constexpr itk::SizeValueType dataSize = 64;
+    constexpr itk::SizeValueType size = SharedMemoryType::DataOffset + dataSize;
+    const int                    descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    ITK_TEST_EXPECT_TRUE(descriptor >= 0 && ftruncate(descriptor, static_cast<off_t>(size)) == 0);
+    void * address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    ITK_TEST_EXPECT_TRUE(address != MAP_FAILED);
+    auto * staleHeader = static_cast<SharedMemoryType::HeaderType *>(address);
+    staleHeader->NumberOfProcesses = 2;
+    staleHeader->Fingerprint = 1;
+    staleHeader->RunIdentifier = runIdentifier + 1;
+    staleHeader->DataSizeInBytes = dataSize;
+    staleHeader->Magic.store(SharedMemoryType::MagicValue);
+
+    SharedMemoryType staleWorker(name, 0.5);
+    ITK_TRY_EXPECT_EXCEPTION(staleWorker.Open(dataSize, 1, runIdentifier, 2));
+    ITK_TEST_EXPECT_EQUAL(0u, staleHeader->NumberOfAttachedProcesses.load());
+    munmap(address, size);
+
+    SharedMemoryType creator(name, 0.5);
+    ITK_TRY_EXPECT_NO_EXCEPTION(creator.Create(dataSize, 1, runIdentifier, 2));
+    SharedMemoryType worker(name, 0.5);
+    ITK_TRY_EXPECT_NO_EXCEPTION(worker.Open(dataSize, 1, runIdentifier, 2));
+    ITK_TEST_EXPECT_EQUAL(2u, worker.GetHeader()->NumberOfAttachedProcesses.load());
+    ITK_TEST_EXPECT_TRUE(shm_open(name.c_str(), O_RDWR, 0) < 0);
+  }
+
+  // Every shard but the first runs in its own process, started through the
+  // test driver
+  const std::string  testDriver = argv[1];
+  std::vector<pid_t> workers;
+  const std::string  run = std::to_string(runIdentifier);
+  for (unsigned int shardIndex = 1; shardIndex < NumberOfShards; ++shardIndex)
+  {
+    std::string  shard = std::to_string(shardIndex);
+    const char * arguments[] = { testDriver.c_str(), "itkPhaseSymmetryShardingTest",
+                                 testDriver.c_str(), name.c_str(),
+                                 run.c_str(),        shard.c_str(),
+                                 nullptr };
+    pid_t worker;
+    if (posix_spawn(&worker, testDriver.c_str(), nullptr, nullptr, const_cast<char **>(arguments), environ) != 0)
+    {
+      std::cerr << "Cannot start shard " << shardIndex << std::endl;
+      return EXIT_FAILURE;
+    }
+    workers.push_back(worker);
+  }
+
+  bool success = RunShard(input, reference, name, runIdentifier, 0);
+  for (const pid_t worker : workers)
+  {
+    int status = 0;
+    waitpid(worker, &status, 0);
+    success = success && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+  }
+  ITK_TEST_EXPECT_TRUE(shm_open(name.c_str(), O_RDWR, 0) < 0);
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+#endif
+}
@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPhaseSymmetryTestHelpers_h
+#define itkPhaseSymmetryTestHelpers_h
+
+#include "itkSinusoidImageSource.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Fixture shared by the tests that compare an execution of
+// PhaseSymmetryImageFilter with a reference run of the filter: a sinusoid
+// input, and a filter with the same polarity, noise threshold and
+// wavelengths.
+
+namespace PhaseSymmetryTestHelpers
+{
+
+/** Create a sinusoid source of a size, whose frequency decreases along the
+ * axes. */
+template <typename TImage>
+typename itk::SinusoidImageSource<TImage>::Pointer
+MakeSource(const typename TImage::SizeType & size, double phaseOffset = 0.3)
+{
+  using SourceType = itk::SinusoidImageSource<TImage>;
+  typename SourceType::Pointer source = SourceType::New();
+  source->SetSize(size);
+  typename SourceType::ArrayType frequency;
+  const double                   frequencies[] = { 0.1, 0.05, 0.02 };
+  for (unsigned int dim = 0; dim < TImage::ImageDimension; ++dim)
+  {
+    frequency[dim] = dim < 3 ? frequencies[dim] : 0.01;
+  }
+  source->SetFrequency(frequency);
+  source->SetPhaseOffset(phaseOffset);
+  return source;
+}
+
+
+/** Generate the output of MakeSource(), disconnected from its source. */
+template <typename TImage>
+typename TImage::Pointer
+MakeInput(const typename TImage::SizeType & size, double phaseOffset = 0.3)
+{
+  typename itk::SinusoidImageSource<TImage>::Pointer source = MakeSource<TImage>(size, phaseOffset);
+  source->Update();
+
+  typename TImage::Pointer input = source->GetOutput();
+  input->DisconnectPipeline();
+  return input;
+}
+
+
+/** Set the polarity, noise threshold and the isotropic wavelengths of each
+ * scale shared by the tests. */
+template <typename TFilter>
+void
+ConfigureFilter(TFilter * filter, const std::vector<double> & scales = { 4.0, 8.0, 16.0 })
+{
+  constexpr unsigned int Dimension = TFilter::InputImageDimension;
+  filter->SetPolarity(1);
+  filter->SetNoiseThreshold(2.0);
+  typename TFilter::MatrixType wavelengths(static_cast<unsigned int>(scales.size()), Dimension);
+  for (unsigned int scale = 0; scale < scales.size(); ++scale)
+  {
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+      wavelengths(scale, dim) = scales[scale];
+    }
+  }
+  filter->SetWavelengths(wavelengths);
+}
+
+
+/** Create a filter of an input, configured by ConfigureFilter(). */
+template <typename TFilter>
+typename TFilter::Pointer
+MakeFilter(const typename TFilter::InputImageType * input, const std::vector<double> & scales = { 4.0, 8.0, 16.0 })
+{
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput(input);
+  ConfigureFilter(filter.GetPointer(), scales);
+  return filter;
+}
+
+
+/** Initialize and update a filter, and return its output disconnected from
+ * it. */
+template <typename TFilter>
+typename TFilter::OutputImageType::Pointer
+RunFilter(itk::SmartPointer<TFilter> filter)
+{
+  filter->Initialize();
+  filter->Update();
+  typename TFilter::OutputImageType::Pointer output = filter->GetOutput();
+  output->DisconnectPipeline();
+  return output;
+}
+
+
+template <typename TImage>
+double
+MaximumAbsoluteDifference(const TImage * image1, const typename TImage::Self * image2)
+{
+  using IteratorType = itk::ImageRegionConstIterator<TImage>;
+  IteratorType it1(image1, image1->GetBufferedRegion());
+  IteratorType it2(image2, image2->GetBufferedRegion());
+  double       difference = 0.0;
+  for (; !it1.IsAtEnd(); ++it1, ++it2)
+  {
+    difference = std::max(difference, std::abs(static_cast<double>(it1.Get()) - static_cast<double>(it2.Get())));
+  }
+  return difference;
+}
+
+
+/** Compare an image with a buffer in the order of its pixels. */
+template <typename TImage>
+double
+MaximumAbsoluteDifference(const TImage * reference, const std::vector<typename TImage::PixelType> & result)
+{
+  const typename TImage::PixelType * referenceBuffer = reference->GetBufferPointer();
+  double                             difference = 0.0;
+  for (std::size_t i = 0; i < result.size(); ++i)
+  {
+    difference = std::max(difference, std::abs(static_cast<double>(referenceBuffer[i]) - result[i]));
+  }
+  return difference;
+}
+
+} // end namespace PhaseSymmetryTestHelpers
+
+#endif
@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPhaseSymmetryWorkloadImageSource.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Checks that the workload source is reproducible from its seed, and that a
+// requested region and a streamed output match the whole image.
+
+namespace
+{
+
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image<float, Dimension>;
+using SourceType = itk::PhaseSymmetryWorkloadImageSource<ImageType>;
+
+
+SourceType::Pointer
+MakeSource(uint64_t seed)
+{
+  SourceType::Pointer     source = SourceType::New();
+  SourceType::SizeType    size = { { 48, 20, 12 } };
+  SourceType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 1.0;
+  spacing[2] = 1.5;
+  SourceType::PointType origin;
+  origin[0] = -4.0;
+  origin[1] = 2.0;
+  origin[2] = 10.0;
+  source->SetSize(size);
+  source->SetSpacing(spacing);
+  source->SetOrigin(origin);
+  SourceType::DirectionType direction;
+  direction.SetIdentity();
+  direction(0, 0) = direction(1, 1) = std::cos(0.3);
+  direction(1, 0) = std::sin(0.3);
+  direction(0, 1) = -direction(1, 0);
+  source->SetDirection(direction);
+  source->SetSeed(seed);
+  source->SetNumberOfSinusoids(5);
+  source->SetNumberOfSurfaces(2);
+  source->SetSpeckleLevel(0.7);
+  return source;
+}
+
+
+// Maximum absolute difference over the region of the first image
+double
+MaximumDifference(const ImageType * image, const ImageType * reference, const ImageType::RegionType & region)
+{
+  double                                            difference = 0.0;
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, region);
+  for (; !it.IsAtEnd(); ++it)
+  {
+    difference = std::max(difference, double(std::abs(it.Get() - reference->GetPixel(it.GetIndex()))));
+  }
+  return difference;
+}
+
+} // end anonymous namespace
+
+
+int
+itkPhaseSymmetryWorkloadImageSourceTest(int, char *[])
+{
+  SourceType::Pointer source = MakeSource(42);
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(source, PhaseSymmetryWorkloadImageSource, GenerateImageSource);
+
+  ITK_TEST_SET_GET_VALUE(42u, source->GetSeed());
+  ITK_TEST_SET_GET_VALUE(5u, source->GetNumberOfSinusoids());
+  ITK_TEST_SET_GET_VALUE(2u, source->GetNumberOfSurfaces());
+  ITK_TEST_SET_GET_VALUE(0.7, source->GetSpeckleLevel());
+
+  bool success = true;
+
+  // A requested region in the middle of the image, generated first
+  SourceType::Pointer subRegionSource = MakeSource(42);
+  subRegionSource->UpdateOutputInformation();
+  ImageType::RegionType subRegion = subRegionSource->GetOutput()->GetLargestPossibleRegion();
+  subRegion.SetIndex(0, 7);
+  subRegion.SetSize(0, 30);
+  subRegion.SetIndex(2, 3);
+  subRegion.SetSize(2, 5);
+  subRegionSource->GetOutput()->SetRequestedRegion(subRegion);
+  ITK_TRY_EXPECT_NO_EXCEPTION(subRegionSource->GetOutput()->Update());
+
+  ITK_TRY_EXPECT_NO_EXCEPTION(source->Update());
+  const ImageType *           whole = source->GetOutput();
+  const ImageType::RegionType largestRegion = whole->GetLargestPossibleRegion();
+
+  // The components span the range of the intensities
+  double minimum = whole->GetPixel(largestRegion.GetIndex());
+  double maximum = minimum;
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(whole, largestRegion);
+  for (; !it.IsAtEnd(); ++it)
+  {
+    minimum = std::min(minimum, double(it.Get()));
+    maximum = std::max(maximum, double(it.Get()));
+  }
+  std::cout << "Intensity range: [" << minimum << ", " << maximum << "]" << std::endl;
+  if (!(minimum < 0.0 && maximum > 1.0))
+  {
+    std::cerr << "Unexpected intensity range" << std::endl;
+    success = false;
+  }
+
+  // Same seed, same image, with a different number of work units
+  SourceType::Pointer sameSeedSource = MakeSource(42);
+  sameSeedSource->SetNumberOfWorkUnits(3);
+  ITK_TRY_EXPECT_NO_EXCEPTION(sameSeedSource->Update());
+  const double sameSeedDifference = MaximumDifference(sameSeedSource->GetOutput(), whole, largestRegion);
+  std::cout << "Same seed: maximum absolute difference " << sameSeedDifference << std::endl;
+  success &= sameSeedDifference == 0.0;
+
+  // Another seed, another image
+  SourceType::Pointer otherSeedSource = MakeSource(43);
+  ITK_TRY_EXPECT_NO_EXCEPTION(otherSeedSource->Update());
+  const double otherSeedDifference = MaximumDifference(otherSeedSource->GetOutput(), whole, largestRegion);
+  std::cout << "Other seed: maximum absolute difference " << otherSeedDifference << std::endl;
+  success &= otherSeedDifference > 0.1;
+
+  const double subRegionDifference = MaximumDifference(subRegionSource->GetOutput(), whole, subRegion);
+  std::cout << "Requested region: maximum absolute difference " << subRegionDifference << std::endl;
+  success &= subRegionDifference == 0.0;
+
+  // Streamed in pieces
+  using StreamerType = itk::StreamingImageFilter<ImageType, ImageType>;
+  StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput(MakeSource(42)->GetOutput());
+  streamer->SetNumberOfStreamDivisions(5);
+  ITK_TRY_EXPECT_NO_EXCEPTION(streamer->Update());
+  const double streamedDifference = MaximumDifference(streamer->GetOutput(), whole, largestRegion);
+  std::cout << "Streamed: maximum absolute difference " << streamedDifference << std::endl;
+  success &= streamedDifference == 0.0;
+
+  // Inverted frequency range
+  SourceType::Pointer invalidSource = MakeSource(42);
+  invalidSource->SetMinimumFrequency(0.3);
+  invalidSource->SetMaximumFrequency(0.1);
+  ITK_TRY_EXPECT_EXCEPTION(invalidSource->Update());
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
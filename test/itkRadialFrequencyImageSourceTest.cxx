@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLogGaborFreqImageSource.h"
+#include "itkButterworthFilterFreqImageSource.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Checks that the radial sources, mirrored from one orthant when the whole
+// image is generated and evaluated directly for a smaller requested region,
+// match a per pixel evaluation of their profile, for odd and even sizes.
+
+namespace
+{
+
+template <typename TImage>
+double
+SquaredRadius(const typename TImage::IndexType & index, const typename TImage::SizeType & size, const double * scales)
+{
+  double radius = 0.0;
+  for (unsigned int ii = 0; ii < TImage::ImageDimension; ++ii)
+  {
+    const double dist = (double(size[ii]) / 2.0 - double(index[ii])) / double(size[ii]) * scales[ii];
+    radius += dist * dist;
+  }
+  return radius;
+}
+
+
+template <typename TSource, typename TProfile>
+bool
+CheckSource(TSource * source, const typename TSource::SizeType & size, const double * scales, TProfile profile)
+{
+  using ImageType = typename TSource::OutputImageType;
+  source->SetSize(size);
+
+  // Whole image, mirrored from one orthant
+  source->Update();
+  typename ImageType::Pointer whole = source->GetOutput();
+  whole->DisconnectPipeline();
+
+  // A requested region that starts past the center, generated directly
+  source->UpdateOutputInformation();
+  typename ImageType::RegionType region = source->GetOutput()->GetLargestPossibleRegion();
+  region.SetIndex(0, size[0] / 2);
+  region.SetSize(0, size[0] - size[0] / 2);
+  source->GetOutput()->SetRequestedRegion(region);
+  source->GetOutput()->Update();
+
+  double                                            difference = 0.0;
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(whole, whole->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const double expected = profile(SquaredRadius<ImageType>(it.GetIndex(), size, scales));
+    difference = std::max(difference, std::abs(expected - it.Get()));
+    if (region.IsInside(it.GetIndex()))
+    {
+      difference = std::max(difference, std::abs(expected - source->GetOutput()->GetPixel(it.GetIndex())));
+    }
+  }
+  std::cout << source->GetNameOfClass() << " " << size << ": maximum absolute difference " << difference
+            << std::endl;
+  return difference <= 1e-6;
+}
+
+
+template <unsigned int VDimension>
+bool
+CheckSources(const itk::Size<VDimension> & size)
+{
+  using ImageType = itk::Image<float, VDimension>;
+  bool success = true;
+
+  using LogGaborSourceType = itk::LogGaborFreqImageSource<ImageType>;
+  typename LogGaborSourceType::Pointer logGaborSource = LogGaborSourceType::New();
+  logGaborSource->SetSigma(0.6);
+  typename LogGaborSourceType::ArrayType wavelengths;
+  double                                 wavelengthValues[VDimension];
+  for (unsigned int ii = 0; ii < VDimension; ++ii)
+  {
+    wavelengths[ii] = wavelengthValues[ii] = 4.0 + 3.0 * ii;
+  }
+  logGaborSource->SetWavelengths(wavelengths);
+  const double logSigma = std::log(0.6);
+  success &= CheckSource(logGaborSource.GetPointer(), size, wavelengthValues, [logSigma](double squaredRadius) {
+    if (squaredRadius == 0.0)
+    {
+      return 0.0;
+    }
+    const double logRadius = std::log(std::sqrt(squaredRadius));
+    return std::exp(-logRadius * logRadius / (2.0 * logSigma * logSigma));
+  });
+
+  using ButterworthSourceType = itk::ButterworthFilterFreqImageSource<ImageType>;
+  typename ButterworthSourceType::Pointer butterworthSource = ButterworthSourceType::New();
+  butterworthSource->SetCutoff(0.3);
+  butterworthSource->SetOrder(4.0);
+  double unitScales[VDimension];
+  std::fill(unitScales, unitScales + VDimension, 1.0);
+  success &= CheckSource(butterworthSource.GetPointer(), size, unitScales, [](double squaredRadius) {
+    return 1.0 / (1.0 + std::pow(std::sqrt(squaredRadius) / 0.3, 8.0));
+  });
+
+  return success;
+}
+
+} // end anonymous namespace
+
+
+int
+itkRadialFrequencyImageSourceTest(int, char *[])
+{
+  bool success = true;
+
+  itk::Size<2> size2D = { { 7, 8 } };
+  success &= CheckSources<2>(size2D);
+  itk::Size<3> size3D = { { 6, 5, 4 } };
+  success &= CheckSources<3>(size3D);
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -18,8 +18,14 @@
 
 #include "itkSimpleFilterWatcher.h"
 #include "itkSinusoidImageSource.h"
+#include "itkSinusoidSpatialFunction.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkTestingMacros.h"
 #include "itkImageFileWriter.h"
+#include "itkForwardFFTImageFilter.h"
+
+#include <algorithm>
+#include <cmath>
 
 int
 itkSinusoidImageSourceTest(int argc, char * argv[])
@@ -145,6 +151,108 @@ itkSinusoidImageSourceTest(int argc, char * argv[])
   writer->SetInput(source->GetOutput());
   ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
 
+  // The recurrence along the scanlines matches a direct evaluation at every
+  // pixel, over long lines, with an oblique direction. The sub-region comes
+  // first, so that it is generated alone.
+  ImageType::SizeType longSize = { { 1000, 7, 5 } };
+  source->SetSize(longSize);
+  ImageType::DirectionType direction;
+  direction.SetIdentity();
+  direction(0, 0) = direction(1, 1) = std::cos(0.3);
+  direction(0, 1) = -std::sin(0.3);
+  direction(1, 0) = std::sin(0.3);
+  source->SetDirection(direction);
+
+  using FunctionType = itk::SinusoidSpatialFunction<double, Dimension>;
+  FunctionType::Pointer sinusoid = FunctionType::New();
+  sinusoid->SetFrequency(source->GetFrequency());
+  sinusoid->SetPhaseOffset(source->GetPhaseOffset());
+
+  ImageType::RegionType subRegion(longSize);
+  subRegion.SetIndex(0, 130);
+  subRegion.SetSize(0, 700);
+  subRegion.SetIndex(2, 3);
+  subRegion.SetSize(2, 2);
+  for (const ImageType::RegionType & region : { subRegion, ImageType::RegionType(longSize) })
+  {
+    source->GetOutput()->SetRequestedRegion(region);
+    ITK_TRY_EXPECT_NO_EXCEPTION(source->GetOutput()->Update());
+    ITK_TEST_EXPECT_EQUAL(source->GetOutput()->GetBufferedRegion(), region);
+
+    double                                             difference = 0.0;
+    itk::ImageRegionConstIteratorWithIndex<ImageType> it(source->GetOutput(), region);
+    for (; !it.IsAtEnd(); ++it)
+    {
+      FunctionType::InputType point;
+      source->GetOutput()->TransformIndexToPhysicalPoint(it.GetIndex(), point);
+      difference = std::max(difference, std::abs(sinusoid->Evaluate(point) - double(it.Get())));
+    }
+    std::cout << "Region " << region.GetIndex() << " " << region.GetSize() << ": maximum absolute difference "
+              << difference << std::endl;
+    if (difference > 1e-6)
+    {
+      std::cerr << "Test failed!" << std::endl;
+      std::cerr << "The generated image differs from the sinusoid by " << difference << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The spectrum output matches the FFT of the image, for a frequency on the
+  // bins, which gives two spikes, and for the oblique one above, which leaks
+  ITK_TRY_EXPECT_EXCEPTION(source->GetSpectrumOutput());
+
+  using SpectrumImageType = SinusoidSourceType::SpectrumImageType;
+  using FFTType = itk::ForwardFFTImageFilter<ImageType, SpectrumImageType>;
+  ImageType::SizeType    spectrumSize = { { 16, 12, 10 } };
+  ImageType::SpacingType spectrumSpacing;
+  spectrumSpacing[0] = 0.5;
+  spectrumSpacing[1] = 1.0;
+  spectrumSpacing[2] = 2.0;
+  SinusoidSourceType::ArrayType binFrequency;
+  binFrequency[0] = 2.0 / (16 * 0.5);
+  binFrequency[1] = 3.0 / (12 * 1.0);
+  binFrequency[2] = 1.0 / (10 * 2.0);
+  ImageType::DirectionType identity;
+  identity.SetIdentity();
+  const SinusoidSourceType::ArrayType frequencies[] = { binFrequency, frequency };
+  const ImageType::DirectionType      directions[] = { identity, direction };
+  const itk::SizeValueType            numberOfPixels = spectrumSize[0] * spectrumSize[1] * spectrumSize[2];
+  for (unsigned int ii = 0; ii < 2; ++ii)
+  {
+    SinusoidSourceType::Pointer spectrumSource = SinusoidSourceType::New();
+    spectrumSource->SetSize(spectrumSize);
+    spectrumSource->SetSpacing(spectrumSpacing);
+    spectrumSource->SetOrigin(origin);
+    spectrumSource->SetDirection(directions[ii]);
+    spectrumSource->SetFrequency(frequencies[ii]);
+    spectrumSource->SetPhaseOffset(0.7);
+    spectrumSource->GenerateSpectrumOn();
+    ITK_TEST_SET_GET_VALUE(true, spectrumSource->GetGenerateSpectrum());
+    ITK_TRY_EXPECT_NO_EXCEPTION(spectrumSource->Update());
+
+    FFTType::Pointer fft = FFTType::New();
+    fft->SetInput(spectrumSource->GetOutput());
+    ITK_TRY_EXPECT_NO_EXCEPTION(fft->Update());
+
+    const SpectrumImageType *                                 spectrum = spectrumSource->GetSpectrumOutput();
+    double                                                    difference = 0.0;
+    itk::SizeValueType                                        peaks = 0;
+    itk::ImageRegionConstIteratorWithIndex<SpectrumImageType> it(spectrum, spectrum->GetBufferedRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      difference = std::max(difference, double(std::abs(it.Get() - fft->GetOutput()->GetPixel(it.GetIndex()))));
+      peaks += std::abs(it.Get()) > 1e-6 * numberOfPixels;
+    }
+    std::cout << "Spectrum " << frequencies[ii] << ": maximum absolute difference " << difference << ", " << peaks
+              << " peaks" << std::endl;
+    if (difference > 1e-5 * numberOfPixels || (ii == 0 && peaks != 2))
+    {
+      std::cerr << "Test failed!" << std::endl;
+      std::cerr << "The spectrum differs from the FFT of the image by " << difference << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   // Instantiate 1D case.
   using Image1DType = itk::Image<PixelType, 1>;
   using SinusoidSource1DType = itk::SinusoidImageSource<Image1DType>;
@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSinusoidSpatialFunction.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Checks that the batch, line and grid evaluations match the per point
+// Evaluate(), over lines long enough to accumulate the recurrence error.
+
+int
+itkSinusoidSpatialFunctionTest(int, char *[])
+{
+  constexpr unsigned int Dimension = 3;
+  using FunctionType = itk::SinusoidSpatialFunction<double, Dimension>;
+  using PointType = FunctionType::InputType;
+
+  FunctionType::Pointer sinusoid = FunctionType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(sinusoid, SinusoidSpatialFunction, SpatialFunction);
+
+  FunctionType::ArrayType frequency;
+  frequency[0] = 0.013;
+  frequency[1] = 0.21;
+  frequency[2] = -0.37;
+  sinusoid->SetFrequency(frequency);
+  sinusoid->SetPhaseOffset(0.4);
+
+  // Grid with oblique steps, of which a line is 1000 points long
+  FunctionType::MatrixType steps;
+  steps(0, 0) = 1.1;
+  steps(1, 0) = 0.2;
+  steps(2, 0) = 0.0;
+  steps(0, 1) = -0.3;
+  steps(1, 1) = 0.9;
+  steps(2, 1) = 0.1;
+  steps(0, 2) = 0.0;
+  steps(1, 2) = 0.05;
+  steps(2, 2) = 1.4;
+  FunctionType::SizeType size = { { 1000, 4, 3 } };
+  PointType              origin;
+  origin[0] = -20.0;
+  origin[1] = 3.5;
+  origin[2] = 7.0;
+
+  const itk::SizeValueType count = size[0] * size[1] * size[2];
+  std::vector<PointType>   points(count);
+  std::vector<double>      expected(count);
+  for (itk::SizeValueType zz = 0, ii = 0; zz < size[2]; ++zz)
+  {
+    for (itk::SizeValueType yy = 0; yy < size[1]; ++yy)
+    {
+      for (itk::SizeValueType xx = 0; xx < size[0]; ++xx, ++ii)
+      {
+        for (unsigned int dd = 0; dd < Dimension; ++dd)
+        {
+          points[ii][dd] = origin[dd] + steps(dd, 0) * xx + steps(dd, 1) * yy + steps(dd, 2) * zz;
+        }
+        expected[ii] = sinusoid->Evaluate(points[ii]);
+      }
+    }
+  }
+
+  std::vector<double> batchValues(count);
+  sinusoid->Evaluate(points.data(), batchValues.data(), count);
+  std::vector<float> gridValues(count);
+  sinusoid->EvaluateGrid(origin, steps, size, gridValues.data());
+
+  double batchDifference = 0.0;
+  double gridDifference = 0.0;
+  for (itk::SizeValueType ii = 0; ii < count; ++ii)
+  {
+    batchDifference = std::max(batchDifference, std::abs(batchValues[ii] - expected[ii]));
+    gridDifference = std::max(gridDifference, std::abs(double(gridValues[ii]) - expected[ii]));
+  }
+  std::cout << "Maximum absolute difference of the batch " << batchDifference << ", of the grid " << gridDifference
+            << std::endl;
+
+  if (batchDifference > 1e-12 || gridDifference > 1e-6)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -16,10 +16,104 @@
  *
  *=========================================================================*/
 
-#include "itkImageFileReader.h"
+#include "itkSteerableFilterFreqImageSource.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Checks that the fast angular evaluation stays within its tolerance of the
+// exact one, over several orientations of the same size, so that the kept
+// unit direction field is reused, and that a requested sub-region matches
+// the whole image with both evaluations.
 
 int
 itkSteerableFilterFreqImageSourceTest(int, char *[])
 {
+  constexpr unsigned int Dimension = 3;
+  using ImageType = itk::Image<float, Dimension>;
+  using SourceType = itk::SteerableFilterFreqImageSource<ImageType>;
+
+  SourceType::Pointer exactSource = SourceType::New();
+  SourceType::Pointer fastSource = SourceType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(fastSource, SteerableFilterFreqImageSource, GenerateImageSource);
+
+  SourceType::SizeType size = { { 16, 15, 8 } };
+  exactSource->SetSize(size);
+  fastSource->SetSize(size);
+
+  const double tolerance = 1e-4;
+  fastSource->SetAngularTolerance(tolerance);
+  ITK_TEST_SET_GET_VALUE(tolerance, fastSource->GetAngularTolerance());
+
+  const double bandwidths[] = { 2.0, 0.5 };
+  const double orientations[][Dimension] = { { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 1 }, { -0.3, 0.8, 0.2 } };
+
+  bool success = true;
+  for (double bandwidth : bandwidths)
+  {
+    for (const auto & orientationValues : orientations)
+    {
+      SourceType::DoubleArrayType orientation;
+      std::copy(orientationValues, orientationValues + Dimension, orientation.Begin());
+      exactSource->SetOrientation(orientation);
+      exactSource->SetAngularBandwidth(bandwidth);
+      fastSource->SetOrientation(orientation);
+      fastSource->SetAngularBandwidth(bandwidth);
+      ITK_TRY_EXPECT_NO_EXCEPTION(exactSource->Update());
+      ITK_TRY_EXPECT_NO_EXCEPTION(fastSource->Update());
+
+      const ImageType::RegionType              region = exactSource->GetOutput()->GetLargestPossibleRegion();
+      itk::ImageRegionConstIterator<ImageType> exactIt(exactSource->GetOutput(), region);
+      itk::ImageRegionConstIterator<ImageType> fastIt(fastSource->GetOutput(), region);
+      double                                   difference = 0.0;
+      for (; !exactIt.IsAtEnd(); ++exactIt, ++fastIt)
+      {
+        difference = std::max(difference, std::abs(double(exactIt.Get()) - double(fastIt.Get())));
+      }
+      std::cout << "Bandwidth " << bandwidth << ", orientation " << orientation << ": maximum absolute difference "
+                << difference << std::endl;
+      // The output is float, and the unit direction field is kept in float
+      success &= difference <= tolerance + 1e-5;
+    }
+  }
+
+  // A requested region off the center, generated alone
+  ImageType::RegionType subRegion = exactSource->GetOutput()->GetLargestPossibleRegion();
+  subRegion.SetIndex(0, 9);
+  subRegion.SetSize(0, 5);
+  subRegion.SetIndex(2, 2);
+  subRegion.SetSize(2, 3);
+  for (SourceType * source : { exactSource.GetPointer(), fastSource.GetPointer() })
+  {
+    ITK_TRY_EXPECT_NO_EXCEPTION(source->Update());
+    ImageType::Pointer whole = source->GetOutput();
+    whole->DisconnectPipeline();
+
+    source->GetOutput()->SetRequestedRegion(subRegion);
+    ITK_TRY_EXPECT_NO_EXCEPTION(source->GetOutput()->Update());
+    ITK_TEST_EXPECT_EQUAL(source->GetOutput()->GetBufferedRegion(), subRegion);
+
+    itk::ImageRegionConstIterator<ImageType> wholeIt(whole, subRegion);
+    itk::ImageRegionConstIterator<ImageType> subIt(source->GetOutput(), subRegion);
+    double                                   difference = 0.0;
+    for (; !subIt.IsAtEnd(); ++wholeIt, ++subIt)
+    {
+      difference = std::max(difference, std::abs(double(wholeIt.Get()) - double(subIt.Get())));
+    }
+    std::cout << "Requested region " << subRegion.GetIndex() << " " << subRegion.GetSize()
+              << ": maximum absolute difference " << difference << std::endl;
+    success &= difference == 0.0;
+  }
+
+  if (!success)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,73 @@
+#==========================================================================
+#
+#   Copyright NumFOCUS
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          http://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+#==========================================================================*/
+
+# Checks that the filter is wrapped with unsigned integer outputs, and that
+# such an instantiation gives the real output rescaled from [0, 1] to the
+# range of its pixel type.
+
+import sys
+
+import itk
+import numpy as np
+
+UNSIGNED_INTEGER_PIXEL_TYPE_NAMES = ('UC', 'US', 'UI', 'UL', 'ULL')
+unsigned_integer_pixel_types = [getattr(itk, name) for name in UNSIGNED_INTEGER_PIXEL_TYPE_NAMES if hasattr(itk, name)]
+
+integer_outputs = []
+for input_type, output_type in itk.PhaseSymmetryImageFilter.keys():
+    input_pixel_type, dimension = itk.template(input_type)[1]
+    if input_pixel_type == itk.F and itk.template(output_type)[1][0] in unsigned_integer_pixel_types:
+        integer_outputs.append((dimension, output_type))
+
+if not integer_outputs:
+    print('No PhaseSymmetryImageFilter instantiation with a float input and an unsigned integer output')
+    sys.exit(1)
+
+dimension, output_type = integer_outputs[0]
+image_type = itk.Image[itk.F, dimension]
+
+source = itk.SinusoidImageSource[image_type].New()
+source.SetSize([32] * dimension)
+source.SetFrequency([0.1] * dimension)
+source.Update()
+
+
+def run(output_image_type):
+    phase_symmetry_filter = itk.PhaseSymmetryImageFilter[image_type, output_image_type].New()
+    phase_symmetry_filter.SetInput(source.GetOutput())
+    phase_symmetry_filter.SetNoiseThreshold(0.0)
+    phase_symmetry_filter.Initialize()
+    phase_symmetry_filter.Update()
+    return itk.array_from_image(phase_symmetry_filter.GetOutput())
+
+
+real_output = run(image_type)
+integer_output = run(output_type)
+
+if not np.issubdtype(integer_output.dtype, np.unsignedinteger):
+    print('Output of {} has the NumPy type {}'.format(output_type, integer_output.dtype))
+    sys.exit(1)
+maximum = float(np.iinfo(integer_output.dtype).max)
+expected = np.clip(real_output.astype(np.float64), 0.0, 1.0) * maximum
+difference = np.max(np.abs(integer_output.astype(np.float64) - expected))
+print('Maximum difference to the rescaled real output: {}'.format(difference))
+if real_output.max() <= 0.0 or difference > 1.0 + 1e-6 * maximum:
+    print('Unsigned integer output differs from the rescaled real output')
+    sys.exit(1)
+
+print('Test finished.')